@@ -4,7 +4,10 @@
 
 #include "awrit.h"
 
-#include <thread>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 
 #include "include/base/cef_atomic_flag.h"
 #include "include/base/cef_bind.h"
@@ -34,7 +37,8 @@ std::string GetDataURI(const std::string& data, const std::string& mime_type) {
 
 }  // namespace
 
-AwritClient::AwritClient() : is_closing_(false), quitting_() {
+AwritClient::AwritClient(const frame::GovernorOptions& governor_options)
+    : is_closing_(false), quitting_(), governor_(governor_options) {
   DCHECK(!g_awrit_client);
   g_awrit_client = this;
   quitting_ = base::MakeRefCounted<base::RefCountedData<base::AtomicFlag>>();
@@ -60,6 +64,7 @@ void AwritClient::OnAfterCreated(CefRefPtr<CefBrowser> browser) {
 
   // Add to the list of existing browsers.
   browser_list_.push_back(browser);
+  if (browser_list_.size() == 1) WakeUp();
 }
 
 bool AwritClient::DoClose(CefRefPtr<CefBrowser> browser) {
@@ -67,7 +72,10 @@ bool AwritClient::DoClose(CefRefPtr<CefBrowser> browser) {
 
   if (browser_list_.size() == 1) {
     is_closing_ = true;
-    if (quitting_) quitting_->data.Set();
+    if (quitting_) {
+      quitting_->data.Set();
+      tty::in::Wake();
+    }
   }
 
   return false;
@@ -85,12 +93,21 @@ void AwritClient::OnBeforeClose(CefRefPtr<CefBrowser> browser) {
   }
 
   if (browser_list_.empty()) {
+    if (journal_) journal_->Close();
     // All browser windows have closed. Quit the application message loop.
     CefQuitMessageLoop();
     return;
   }
 }
 
+void AwritClient::OnLoadStart(CefRefPtr<CefBrowser> browser,
+                              CefRefPtr<CefFrame> frame,
+                              TransitionType transition_type) {
+  CEF_REQUIRE_UI_THREAD();
+  // the next page starts with a full frame anyway
+  if (frame->IsMain()) DropImages();
+}
+
 void AwritClient::OnLoadError(CefRefPtr<CefBrowser> browser,
                               CefRefPtr<CefFrame> frame, ErrorCode errorCode,
                               const CefString& errorText,
@@ -132,6 +149,43 @@ void AwritClient::CloseAllBrowsers(bool force_close) {
   }
 }
 
+void AwritClient::OnInput() {
+  if (governor_.Input()) WakeUp();
+}
+
+void AwritClient::WakeUp() {
+  if (!CefCurrentlyOn(TID_UI)) {
+    CefPostTask(TID_UI, base::BindOnce(&AwritClient::WakeUp, this));
+    return;
+  }
+  // the pending tick may be far off at the idle or paused rate
+  BeginFrame(++begin_frame_generation_);
+}
+
+void AwritClient::BeginFrame(uint64_t generation) {
+  CEF_REQUIRE_UI_THREAD();
+  if (is_closing_ || generation != begin_frame_generation_) return;
+
+  auto previous = governor_.state();
+  auto state = governor_.Tick();
+  if (state != previous) LogStats(governor_.Format());
+
+  if (auto active = Active()) {
+    SendHeldInput();
+    if (TakeRescale()) {
+      active->GetHost()->NotifyScreenInfoChanged();
+      active->GetHost()->WasResized();
+    }
+    if (TakeRepaint()) active->GetHost()->Invalidate(PET_VIEW);
+    if (ReadyForFrame()) active->GetHost()->SendExternalBeginFrame();
+  }
+  auto interval = std::chrono::duration_cast<std::chrono::milliseconds>(
+      governor_.Interval(state));
+  CefPostDelayedTask(
+      TID_UI, base::BindOnce(&AwritClient::BeginFrame, this, generation),
+      interval.count());
+}
+
 void AwritClient::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) {
   auto x = WindowSize();
   rect.Set(0, 0, x.width, x.height);
@@ -146,35 +200,86 @@ void AwritClient::GetViewRect(CefRefPtr<CefBrowser> browser, CefRect& rect) {
 void AwritClient::OnPaint(CefRefPtr<CefBrowser> browser, PaintElementType type,
                           const RectList& dirtyRects, const void* buffer,
                           int width, int height) {
-  // ignore popups for now
-  if (type != PaintElementType::PET_VIEW) return;
+  if (governor_.Painted()) WakeUp();
+  if (type == PaintElementType::PET_POPUP) {
+    float scale = 1;
+#if defined(OS_MAC)
+    extern float MacGetScale();
+    scale = MacGetScale();
+#endif
+    // the terminal places images in its own pixels
+    CefRect rect(popup_rect_.x * scale, popup_rect_.y * scale,
+                 popup_rect_.width * scale, popup_rect_.height * scale);
+    PaintPopup(buffer, width, height, rect);
+    return;
+  }
 
+  if (journal_) {
+    std::vector<frame::Rect> dirty;
+    dirty.reserve(dirtyRects.size());
+    for (const auto& rect : dirtyRects) {
+      dirty.push_back({rect.x, rect.y, rect.width, rect.height});
+    }
+    journal_->Write(buffer, {width, height}, dirty);
+  }
   Paint(dirtyRects, buffer, width, height);
 }
 
+bool AwritClient::Record(const std::string& path) {
+  CEF_REQUIRE_UI_THREAD();
+  journal_ = std::make_unique<frame::JournalWriter>();
+  if (journal_->Open(path)) return true;
+  journal_.reset();
+  return false;
+}
+
+void AwritClient::OnPopupShow(CefRefPtr<CefBrowser> browser, bool show) {
+  CEF_REQUIRE_UI_THREAD();
+  if (show) return;
+  popup_rect_ = {};
+  HidePopup();
+}
+
+void AwritClient::OnPopupSize(CefRefPtr<CefBrowser> browser,
+                              const CefRect& rect) {
+  CEF_REQUIRE_UI_THREAD();
+  popup_rect_ = rect;
+}
+
 void AwritClient::ListenToInput(
     CefRefPtr<base::RefCountedData<base::AtomicFlag>> quitting) {
   InputEventParserImpl parser;
 
+  // blocks until there is input or DoClose wakes it to quit
   while (!quitting->data.IsSet()) {
-    if (!tty::in::WaitForReady(10)) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      continue;
+    auto wait = tty::in::WaitForReady(-1);
+    if (wait == tty::in::Wait::error) {
+      fprintf(stderr, "Failed to wait for input: %s\r\n", strerror(errno));
+      break;
     }
-    parser.Parse(tty::in::Read());
+    if (wait != tty::in::Wait::ready) continue;
+    auto input = tty::in::Read();
+    if (input.empty()) break;
+    parser.Parse(input);
+    parser.Flush();
   }
 }
 
-Awrit::Awrit() {}
+Awrit::Awrit(const frame::GovernorOptions& governor_options)
+    : governor_options_(governor_options) {}
 
 void Awrit::OnContextInitialized() {
   CEF_REQUIRE_UI_THREAD();
-  CefRefPtr<AwritClient> client(new AwritClient());
+  CefRefPtr<AwritClient> client(new AwritClient(governor_options_));
   CefBrowserSettings browser_settings;
-  browser_settings.windowless_frame_rate = 40;
+  // an opaque background keeps frames opaque so they can be sent as RGB
+  browser_settings.background_color = CefColorSetARGB(255, 255, 255, 255);
 
   CefRefPtr<CefCommandLine> command_line =
       CefCommandLine::GetGlobalCommandLine();
+  if (command_line->HasSwitch("record")) {
+    client->Record(command_line->GetSwitchValue("record").ToString());
+  }
 
   std::vector<CefString> args;
   command_line->GetArguments(args);
@@ -194,6 +299,9 @@ void Awrit::OnContextInitialized() {
 
   CefWindowInfo window_info;
   window_info.SetAsWindowless(0L);
+  // frames are paced by the terminal's acknowledgements and the governor, see
+  // BeginFrame
+  window_info.external_begin_frame_enabled = true;
 
   CefBrowserHost::CreateBrowser(window_info, client, url, browser_settings,
                                 nullptr, nullptr);
@@ -213,20 +321,22 @@ void Awrit::OnBeforeCommandLineProcessing(
 
 bool AwritClient::GetScreenInfo(CefRefPtr<CefBrowser> browser,
                                 CefScreenInfo& screen_info) {
-#if defined(OS_MAC)
   CEF_REQUIRE_UI_THREAD();
 
   CefRect view_rect;
   GetViewRect(browser, view_rect);
 
+  float scale = 1;
+#if defined(OS_MAC)
   extern float MacGetScale();
-  screen_info.device_scale_factor = MacGetScale();
+  scale = MacGetScale();
+#endif
+  // the view keeps its size and layout, only fewer pixels are rendered and
+  // the terminal stretches them back over the window
+  screen_info.device_scale_factor = scale * RenderScale();
 
   screen_info.rect = view_rect;
   screen_info.available_rect = view_rect;
 
   return true;
-#else
-  return false;
-#endif
 }
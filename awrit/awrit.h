@@ -6,7 +6,11 @@
 #define AWRIT_AWRIT_H_
 
 #include <list>
+#include <memory>
+#include <string>
 
+#include "frame/governor.h"
+#include "frame/journal.h"
 #include "include/base/cef_atomic_flag.h"
 #include "include/cef_app.h"
 #include "include/cef_render_handler.h"
@@ -18,7 +22,7 @@ class AwritClient : public CefClient,
                     public CefLoadHandler,
                     public CefRenderHandler {
  public:
-  AwritClient();
+  explicit AwritClient(const frame::GovernorOptions& governor_options = {});
   ~AwritClient();
 
   static AwritClient* GetInstance();
@@ -45,6 +49,9 @@ class AwritClient : public CefClient,
   virtual void OnBeforeClose(CefRefPtr<CefBrowser> browser) override;
 
   // CefLoadHandler
+  virtual void OnLoadStart(CefRefPtr<CefBrowser> browser,
+                           CefRefPtr<CefFrame> frame,
+                           TransitionType transition_type) override;
   virtual void OnLoadError(CefRefPtr<CefBrowser> browser,
                            CefRefPtr<CefFrame> frame, ErrorCode errorCode,
                            const CefString& errorText,
@@ -57,8 +64,14 @@ class AwritClient : public CefClient,
                int height) override;
   bool GetScreenInfo(CefRefPtr<CefBrowser> browser,
                      CefScreenInfo& screen_info) override;
+  void OnPopupShow(CefRefPtr<CefBrowser> browser, bool show) override;
+  void OnPopupSize(CefRefPtr<CefBrowser> browser, const CefRect& rect) override;
 
   void CloseAllBrowsers(bool force_close);
+  // Keeps the frame rate up while the user interacts, from any thread
+  void OnInput();
+  // Records every frame of the view to the journal at |path|
+  bool Record(const std::string& path);
 
   bool IsClosing() const { return is_closing_; }
   CefRefPtr<CefBrowser> Active() {
@@ -76,13 +89,25 @@ class AwritClient : public CefClient,
   bool is_closing_;
   CefRefPtr<CefThread> input_thread_;
   CefRefPtr<base::RefCountedData<base::AtomicFlag>> quitting_;
+  frame::FrameGovernor governor_;
+  // where the open popup goes, in view coordinates
+  CefRect popup_rect_;
+  // ticks of an older generation were replaced by faster ones and stop
+  uint64_t begin_frame_generation_ = 0;
+  // set while recording
+  std::unique_ptr<frame::JournalWriter> journal_;
+
+  // Renders a frame if the terminal is ready for one and schedules the next
+  void BeginFrame(uint64_t generation);
+  // Restarts the ticks at the governor's current rate
+  void WakeUp();
 
   IMPLEMENT_REFCOUNTING(AwritClient);
 };
 
 class Awrit : public CefApp, public CefBrowserProcessHandler {
  public:
-  Awrit();
+  explicit Awrit(const frame::GovernorOptions& governor_options = {});
   CefRefPtr<CefBrowserProcessHandler> GetBrowserProcessHandler() override {
     return this;
   }
@@ -94,6 +119,8 @@ class Awrit : public CefApp, public CefBrowserProcessHandler {
       CefRefPtr<CefCommandLine> command_line) override;
 
  private:
+  frame::GovernorOptions governor_options_;
+
   IMPLEMENT_REFCOUNTING(Awrit);
 };
 
@@ -0,0 +1,108 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "cleanup.h"
+
+#include <dirent.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace frame {
+
+namespace {
+
+struct Registration {
+  std::atomic<bool> used{false};
+  NameKind kind;
+  char name[256];
+};
+Registration g_registry[kMaxRegistered];
+
+void Unlink(const char* name, NameKind kind) {
+  if (kind == NameKind::shm) {
+    shm_unlink(name);
+  } else {
+    unlink(name);
+  }
+}
+
+constexpr int kCleanupSignals[] = {SIGINT, SIGTERM, SIGHUP, SIGQUIT};
+struct sigaction g_previous[sizeof(kCleanupSignals) / sizeof(int)];
+
+void OnSignal(int signum) {
+  UnlinkRegistered();
+  for (size_t i = 0; i < sizeof(kCleanupSignals) / sizeof(int); ++i) {
+    if (kCleanupSignals[i] == signum) sigaction(signum, &g_previous[i], nullptr);
+  }
+  raise(signum);
+}
+
+}  // namespace
+
+bool Register(const std::string& name, NameKind kind) {
+  if (name.size() >= sizeof(Registration::name)) return false;
+  for (auto& slot : g_registry) {
+    if (slot.used.load(std::memory_order_acquire)) continue;
+    snprintf(slot.name, sizeof(slot.name), "%s", name.c_str());
+    slot.kind = kind;
+    slot.used.store(true, std::memory_order_release);
+    return true;
+  }
+  return false;
+}
+
+void Unregister(const std::string& name) {
+  for (auto& slot : g_registry) {
+    if (slot.used.load(std::memory_order_acquire) && name == slot.name) {
+      slot.used.store(false, std::memory_order_release);
+      return;
+    }
+  }
+}
+
+void UnlinkRegistered() {
+  for (auto& slot : g_registry) {
+    if (slot.used.load(std::memory_order_acquire)) Unlink(slot.name, slot.kind);
+  }
+}
+
+void InstallSignalHandlers() {
+  struct sigaction action = {};
+  action.sa_handler = OnSignal;
+  sigemptyset(&action.sa_mask);
+  for (size_t i = 0; i < sizeof(kCleanupSignals) / sizeof(int); ++i) {
+    sigaction(kCleanupSignals[i], &action, &g_previous[i]);
+  }
+}
+
+void SweepStale(const char* dir_path, const char* prefix, NameKind kind) {
+  DIR* dir = opendir(dir_path);
+  if (!dir) return;
+
+  const size_t prefix_len = strlen(prefix);
+  while (dirent* entry = readdir(dir)) {
+    if (strncmp(entry->d_name, prefix, prefix_len) != 0) continue;
+
+    char* end = nullptr;
+    long pid = strtol(entry->d_name + prefix_len, &end, 10);
+    if (end == entry->d_name + prefix_len || *end != '-' || pid <= 0) continue;
+    if (kill(pid, 0) == 0 || errno != ESRCH) continue;
+
+    if (kind == NameKind::shm) {
+      shm_unlink(("/" + std::string(entry->d_name)).c_str());
+    } else {
+      unlink((std::string(dir_path) + "/" + entry->d_name).c_str());
+    }
+  }
+  closedir(dir);
+}
+
+}  // namespace frame
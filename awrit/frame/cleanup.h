@@ -0,0 +1,36 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_CLEANUP_H
+#define AWRIT_FRAME_CLEANUP_H
+
+#include <cstddef>
+#include <string>
+
+namespace frame {
+
+// Names of every live shared memory segment and frame file are mirrored into
+// fixed storage so that a signal handler can remove them without allocating
+// or taking locks.
+constexpr size_t kMaxRegistered = 64;
+
+enum class NameKind { shm, file };
+
+// Returns false when every slot is taken
+bool Register(const std::string& name, NameKind kind);
+void Unregister(const std::string& name);
+
+// Unlinks every registered name, async-signal-safe
+void UnlinkRegistered();
+// Unlinks every registered name before the process dies of SIGINT, SIGTERM,
+// SIGHUP or SIGQUIT
+void InstallSignalHandlers();
+
+// Removes the entries of |dir| named |prefix|<pid>-... that were left behind
+// by awrit processes that no longer exist
+void SweepStale(const char* dir, const char* prefix, NameKind kind);
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_CLEANUP_H
@@ -0,0 +1,48 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "compress.h"
+
+#include <zlib.h>
+
+namespace frame {
+
+bool Compress(const void* data, size_t size, std::string& out) {
+  uLongf out_size = compressBound(size);
+  out.resize(out_size);
+  int result = compress2(reinterpret_cast<Bytef*>(out.data()), &out_size,
+                         static_cast<const Bytef*>(data), size, Z_BEST_SPEED);
+  if (result != Z_OK) return false;
+  out.resize(out_size);
+  return true;
+}
+
+bool Decompress(const void* data, size_t size, std::string& out) {
+  z_stream stream = {};
+  if (inflateInit(&stream) != Z_OK) return false;
+
+  stream.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+  stream.avail_in = size;
+  out.clear();
+
+  int result = Z_OK;
+  char buffer[16384];
+  while (result == Z_OK) {
+    stream.next_out = reinterpret_cast<Bytef*>(buffer);
+    stream.avail_out = sizeof(buffer);
+    result = inflate(&stream, Z_NO_FLUSH);
+    out.append(buffer, sizeof(buffer) - stream.avail_out);
+  }
+  inflateEnd(&stream);
+  return result == Z_STREAM_END;
+}
+
+bool Decompress(const void* data, size_t size, void* out, size_t out_size) {
+  uLongf inflated = out_size;
+  int result = uncompress(static_cast<Bytef*>(out), &inflated,
+                          static_cast<const Bytef*>(data), size);
+  return result == Z_OK && inflated == out_size;
+}
+
+}  // namespace frame
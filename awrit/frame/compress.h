@@ -0,0 +1,24 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_COMPRESS_H
+#define AWRIT_FRAME_COMPRESS_H
+
+#include <cstddef>
+#include <string>
+
+namespace frame {
+
+// Compresses |size| bytes at |data| into a zlib stream (RFC 1950), favouring
+// speed over ratio. |out| is reused to avoid reallocating for every frame.
+bool Compress(const void* data, size_t size, std::string& out);
+
+// Inflates a zlib stream, used to check what the terminal would decode
+bool Decompress(const void* data, size_t size, std::string& out);
+// Inflates a zlib stream that is known to hold exactly |out_size| bytes
+bool Decompress(const void* data, size_t size, void* out, size_t out_size);
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_COMPRESS_H
@@ -0,0 +1,65 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "damage.h"
+
+#include <limits>
+
+namespace frame {
+
+namespace {
+
+// extra pixels uploaded if |a| and |b| are sent as their union
+int64_t MergeCost(const Rect& a, const Rect& b) {
+  return a.Union(b).Area() - a.Area() - b.Area() + a.Intersect(b).Area();
+}
+
+}  // namespace
+
+DamagePlan PlanDamage(const std::vector<Rect>& dirty, Size surface,
+                      const DamageOptions& options) {
+  DamagePlan plan;
+  const Rect bounds{0, 0, surface.width, surface.height};
+  if (bounds.IsEmpty()) return plan;
+
+  for (const auto& rect : dirty) {
+    Rect clipped = rect.Intersect(bounds);
+    if (!clipped.IsEmpty()) plan.rects.push_back(clipped);
+  }
+
+  auto& rects = plan.rects;
+  while (rects.size() > 1) {
+    size_t best_i = 0, best_j = 0;
+    int64_t best_cost = std::numeric_limits<int64_t>::max();
+    for (size_t i = 0; i < rects.size(); ++i) {
+      for (size_t j = i + 1; j < rects.size(); ++j) {
+        int64_t cost = MergeCost(rects[i], rects[j]);
+        if (cost < best_cost) {
+          best_cost = cost;
+          best_i = i;
+          best_j = j;
+        }
+      }
+    }
+
+    if (best_cost > options.rect_overhead &&
+        rects.size() <= options.max_rects)
+      break;
+
+    rects[best_i] = rects[best_i].Union(rects[best_j]);
+    rects.erase(rects.begin() + best_j);
+  }
+
+  int64_t damaged = 0;
+  for (const auto& rect : rects) damaged += rect.Area();
+
+  if (damaged >= bounds.Area() * options.full_frame_threshold) {
+    plan.full_frame = true;
+    plan.rects = {bounds};
+  }
+
+  return plan;
+}
+
+}  // namespace frame
@@ -0,0 +1,39 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_DAMAGE_H
+#define AWRIT_FRAME_DAMAGE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rect.h"
+
+namespace frame {
+
+struct DamageOptions {
+  // Fixed cost of a single rect upload (escape sequence, shm segment,
+  // terminal-side decode) expressed in pixels. Two rects are merged when the
+  // pixels wasted by their union are cheaper than this.
+  int64_t rect_overhead = 64 * 64;
+  // Fraction of the surface past which a full frame is sent instead.
+  float full_frame_threshold = 0.7f;
+  // Upper bound on the number of rects, the cheapest pairs are merged first.
+  size_t max_rects = 16;
+};
+
+struct DamagePlan {
+  bool full_frame = false;
+  std::vector<Rect> rects;
+};
+
+// Clips |dirty| to |surface| and merges it into a small set of rects worth
+// uploading individually, or decides that a full frame is cheaper.
+DamagePlan PlanDamage(const std::vector<Rect>& dirty, Size surface,
+                      const DamageOptions& options = {});
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_DAMAGE_H
@@ -0,0 +1,65 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "damage.h"
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+using namespace frame;
+
+TEST(DamageTest, NoDamage) {
+  auto plan = PlanDamage({}, {1000, 1000});
+  EXPECT_FALSE(plan.full_frame);
+  EXPECT_TRUE(plan.rects.empty());
+}
+
+TEST(DamageTest, EmptySurface) {
+  auto plan = PlanDamage({{0, 0, 10, 10}}, {0, 0});
+  EXPECT_FALSE(plan.full_frame);
+  EXPECT_TRUE(plan.rects.empty());
+}
+
+TEST(DamageTest, SingleSmallRect) {
+  auto plan = PlanDamage({{10, 20, 2, 16}}, {1000, 1000});
+  EXPECT_FALSE(plan.full_frame);
+  std::vector<Rect> expected = {{10, 20, 2, 16}};
+  EXPECT_EQ(plan.rects, expected);
+}
+
+TEST(DamageTest, ClipsToSurface) {
+  auto plan = PlanDamage({{990, -5, 20, 10}}, {1000, 1000});
+  std::vector<Rect> expected = {{990, 0, 10, 5}};
+  EXPECT_EQ(plan.rects, expected);
+}
+
+TEST(DamageTest, MergesNearbyRects) {
+  auto plan = PlanDamage({{0, 0, 10, 10}, {12, 0, 10, 10}}, {1000, 1000});
+  std::vector<Rect> expected = {{0, 0, 22, 10}};
+  EXPECT_EQ(plan.rects, expected);
+}
+
+TEST(DamageTest, KeepsDistantRects) {
+  auto plan = PlanDamage({{0, 0, 10, 10}, {900, 900, 10, 10}}, {1000, 1000});
+  EXPECT_FALSE(plan.full_frame);
+  EXPECT_EQ(plan.rects.size(), 2u);
+}
+
+TEST(DamageTest, LimitsRectCount) {
+  std::vector<Rect> dirty;
+  for (int i = 0; i < 10; ++i) dirty.push_back({i * 100, i * 100, 1, 1});
+
+  DamageOptions options;
+  options.max_rects = 4;
+  auto plan = PlanDamage(dirty, {1000, 1000}, options);
+  EXPECT_LE(plan.rects.size(), 4u);
+}
+
+TEST(DamageTest, FullFrameWhenMostlyDamaged) {
+  auto plan = PlanDamage({{0, 0, 1000, 800}}, {1000, 1000});
+  EXPECT_TRUE(plan.full_frame);
+  std::vector<Rect> expected = {{0, 0, 1000, 1000}};
+  EXPECT_EQ(plan.rects, expected);
+}
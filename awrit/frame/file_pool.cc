@@ -0,0 +1,172 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "file_pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+
+#include "cleanup.h"
+
+namespace frame {
+
+namespace {
+
+// the graphics protocol wants this marker in the names of temporary files,
+// it also tells anyone looking at the directory what the files are
+constexpr char kNamePrefix[] = "tty-graphics-protocol-awrit-";
+
+std::string NextPath(const std::string& dir) {
+  static std::atomic<uint32_t> counter{0};
+  return dir + "/" + kNamePrefix + std::to_string(getpid()) + "-" +
+         std::to_string(counter++);
+}
+
+// Creates the file without a name and links it once it has its final size,
+// so the terminal and SweepStale never see it half made
+int OpenUnnamed(const std::string& dir, const std::string& path,
+                size_t capacity) {
+#if defined(O_TMPFILE)
+  int fd = open(dir.c_str(), O_TMPFILE | O_RDWR, 0600);
+  if (fd < 0) return -1;
+
+  char proc_path[32];
+  snprintf(proc_path, sizeof(proc_path), "/proc/self/fd/%d", fd);
+  if (ftruncate(fd, capacity) < 0 ||
+      linkat(AT_FDCWD, proc_path, AT_FDCWD, path.c_str(),
+             AT_SYMLINK_FOLLOW) < 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+#else
+  (void)dir;
+  (void)path;
+  (void)capacity;
+  return -1;
+#endif
+}
+
+}  // namespace
+
+FilePool::FilePool(FilePoolOptions options)
+    : options_(std::move(options)), recycler_(options_.timeout) {
+  if (options_.dir.empty()) options_.dir = DefaultDir();
+  if (options_.max_files > kMaxRegistered) options_.max_files = kMaxRegistered;
+}
+
+FilePool::~FilePool() { Clear(); }
+
+std::string FilePool::DefaultDir() {
+  for (const char* name : {"XDG_RUNTIME_DIR", "TMPDIR"}) {
+    const char* dir = getenv(name);
+    if (dir && *dir && access(dir, W_OK | X_OK) == 0) return dir;
+  }
+  return "/tmp";
+}
+
+FrameFile* FilePool::Acquire(size_t size) {
+  if (size == 0) return nullptr;
+
+  FrameFile* result = recycler_.Pick(files_, size);
+  if (!result) {
+    // every file is in flight, the terminal may still be reading them
+    if (files_.size() >= options_.max_files ||
+        allocated_bytes_ + size > options_.max_bytes)
+      return nullptr;
+    auto file = std::make_unique<FrameFile>();
+    if (!Create(*file, size)) return nullptr;
+    files_.push_back(std::move(file));
+    return files_.back().get();
+  }
+
+  if (result->capacity < size && !Resize(*result, size)) return nullptr;
+  result->in_flight = false;
+  return result;
+}
+
+void FilePool::Clear() {
+  for (auto& file : files_) Destroy(*file);
+  files_.clear();
+}
+
+bool FilePool::Create(FrameFile& file, size_t capacity) {
+  file.path = NextPath(options_.dir);
+  file.fd = OpenUnnamed(options_.dir, file.path, capacity);
+  if (file.fd < 0) {
+    // O_TMPFILE is not supported everywhere
+    file.fd = open(file.path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (file.fd < 0) {
+      fprintf(stderr, "NO FILE %s\r\n", file.path.c_str());
+      file.path.clear();
+      return false;
+    }
+    if (ftruncate(file.fd, capacity) < 0) {
+      Destroy(file);
+      return false;
+    }
+  }
+  Register(file.path, NameKind::file);
+
+  file.capacity = capacity;
+  allocated_bytes_ += capacity;
+  if (!Map(file)) {
+    Destroy(file);
+    return false;
+  }
+  return true;
+}
+
+bool FilePool::Resize(FrameFile& file, size_t capacity) {
+  if (file.data) {
+    munmap(file.data, file.capacity);
+    file.data = nullptr;
+  }
+  if (ftruncate(file.fd, capacity) < 0) {
+    fprintf(stderr, "BAD SIZE %zu\r\n", capacity);
+    return false;
+  }
+  allocated_bytes_ = allocated_bytes_ - file.capacity + capacity;
+  file.capacity = capacity;
+  return Map(file);
+}
+
+bool FilePool::Map(FrameFile& file) {
+  int flags = MAP_SHARED;
+#if defined(__linux__)
+  flags |= MAP_POPULATE;
+#endif
+  void* data =
+      mmap(nullptr, file.capacity, PROT_READ | PROT_WRITE, flags, file.fd, 0);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "MAP FAILED %s\r\n", file.path.c_str());
+    return false;
+  }
+  file.data = data;
+  return true;
+}
+
+void FilePool::Destroy(FrameFile& file) {
+  if (file.data) munmap(file.data, file.capacity);
+  if (file.fd >= 0) close(file.fd);
+  if (!file.path.empty()) {
+    unlink(file.path.c_str());
+    Unregister(file.path);
+  }
+  allocated_bytes_ -= file.capacity;
+  file = FrameFile{};
+}
+
+void FilePool::SweepStale(const std::string& dir) {
+  frame::SweepStale(dir.c_str(), kNamePrefix, NameKind::file);
+}
+
+}  // namespace frame
@@ -0,0 +1,95 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_FILE_POOL_H
+#define AWRIT_FRAME_FILE_POOL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "recycler.h"
+
+namespace frame {
+
+// |capacity| is the size of the file, which may be larger than what was last
+// written
+struct FrameFile : PooledBuffer {
+  std::string path;
+  // the whole file mapped shared, written in place
+  void* data = nullptr;
+  int fd = -1;
+};
+
+struct FilePoolOptions {
+  // directory holding the files, preferably on tmpfs, see DefaultDir
+  std::string dir;
+  size_t max_files = 32;
+  // once the files add up to this many bytes no more are created
+  size_t max_bytes = size_t{1} << 30;
+  // after this long without an answer a file is assumed read, see Recycler
+  Recycler::Clock::duration timeout = std::chrono::milliseconds(250);
+};
+
+// Regular files that frames are written to and handed to the terminal by
+// path, for terminals that can read our files but not our shared memory. The
+// terminal leaves them in place, so they are recycled between frames once it
+// acknowledged reading them, see Recycler. Files are kept mapped like shm
+// segments so frames are converted straight into them.
+//
+// Files are registered for cleanup, see cleanup.h, and named after our pid so
+// that SweepStale can remove the files of a process that crashed.
+class FilePool {
+ public:
+  explicit FilePool(FilePoolOptions options = {});
+  ~FilePool();
+
+  FilePool(const FilePool&) = delete;
+  FilePool& operator=(const FilePool&) = delete;
+
+  // $XDG_RUNTIME_DIR, which is a per-user tmpfs, or else $TMPDIR or /tmp
+  static std::string DefaultDir();
+
+  // Returns a mapped file of at least |size| bytes, nullptr on failure or
+  // when the files in flight already reach |max_files| or |max_bytes|
+  FrameFile* Acquire(size_t size);
+  // Marks |file| as handed to the terminal, |acknowledge| when the command
+  // naming it asks for an answer
+  void Submit(FrameFile* file, bool acknowledge) {
+    recycler_.Submit(*file, acknowledge);
+  }
+  // The terminal answered |count| more commands that asked for it
+  void Acknowledged(uint64_t count = 1) { recycler_.Acknowledged(count); }
+  // Makes every file reusable, for when the terminal stopped answering
+  void ReleaseAll() {
+    for (auto& file : files_) recycler_.Release(*file);
+  }
+  // Unlinks and closes every file
+  void Clear();
+
+  const std::string& dir() const { return options_.dir; }
+  size_t file_count() const { return files_.size(); }
+  size_t allocated_bytes() const { return allocated_bytes_; }
+
+  // Removes the files left behind in |dir| by processes that no longer exist
+  static void SweepStale(const std::string& dir);
+
+ private:
+  FilePoolOptions options_;
+  Recycler recycler_;
+  size_t allocated_bytes_ = 0;
+  std::vector<std::unique_ptr<FrameFile>> files_;
+
+  bool Create(FrameFile& file, size_t capacity);
+  bool Resize(FrameFile& file, size_t capacity);
+  bool Map(FrameFile& file);
+  void Destroy(FrameFile& file);
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_FILE_POOL_H
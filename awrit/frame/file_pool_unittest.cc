@@ -0,0 +1,124 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "file_pool.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "cleanup.h"
+
+using namespace frame;
+
+namespace {
+bool Exists(const std::string& path) { return access(path.c_str(), F_OK) == 0; }
+
+std::string ReadFile(const std::string& path, size_t size) {
+  std::string data(size, '\0');
+  FILE* file = fopen(path.c_str(), "rb");
+  if (!file) return {};
+  data.resize(fread(data.data(), 1, size, file));
+  fclose(file);
+  return data;
+}
+}  // namespace
+
+TEST(FilePoolTest, WritesAreVisibleByPath) {
+  FilePool pool;
+  auto* file = pool.Acquire(1000);
+  ASSERT_NE(file, nullptr);
+  EXPECT_GE(file->capacity, 1000u);
+  EXPECT_NE(file->path.find("tty-graphics-protocol"), std::string::npos);
+
+  std::string data(1000, 'x');
+  memcpy(file->data, data.data(), data.size());
+  EXPECT_EQ(ReadFile(file->path, data.size()), data);
+}
+
+TEST(FilePoolTest, RecyclesOnceAcknowledged) {
+  FilePool pool;
+
+  auto* first = pool.Acquire(4096);
+  pool.Submit(first, true);
+
+  // the terminal may still be reading the first one
+  auto* second = pool.Acquire(4096);
+  EXPECT_NE(first, second);
+  pool.Submit(second, true);
+
+  pool.Acknowledged();
+  EXPECT_EQ(pool.Acquire(4096), first);
+  EXPECT_EQ(pool.file_count(), 2u);
+}
+
+TEST(FilePoolTest, AccountsForSize) {
+  FilePoolOptions options;
+  options.max_bytes = 10000;
+  FilePool pool(options);
+
+  auto* first = pool.Acquire(4000);
+  pool.Submit(first, true);
+  auto* second = pool.Acquire(5000);
+  pool.Submit(second, true);
+  EXPECT_EQ(pool.allocated_bytes(), 9000u);
+
+  // a third file would go over the limit and both are in flight
+  EXPECT_EQ(pool.Acquire(6000), nullptr);
+
+  // once read, the larger one is grown instead
+  pool.Acknowledged(2);
+  EXPECT_EQ(pool.Acquire(6000), second);
+  EXPECT_EQ(pool.file_count(), 2u);
+  EXPECT_EQ(pool.allocated_bytes(), 10000u);
+
+  pool.Clear();
+  EXPECT_EQ(pool.allocated_bytes(), 0u);
+}
+
+TEST(FilePoolTest, RecoversWithoutAnswers) {
+  FilePoolOptions options;
+  options.max_files = 2;
+  options.timeout = std::chrono::milliseconds(10);
+  FilePool pool(options);
+  for (int i = 0; i < 2; ++i) pool.Submit(pool.Acquire(4096), true);
+  EXPECT_EQ(pool.Acquire(4096), nullptr);
+
+  std::this_thread::sleep_for(options.timeout);
+  EXPECT_NE(pool.Acquire(4096), nullptr);
+  EXPECT_EQ(pool.file_count(), 2u);
+}
+
+TEST(FilePoolTest, ReleasesAllOnceUnanswered) {
+  FilePoolOptions options;
+  options.max_files = 1;
+  FilePool pool(options);
+  auto* file = pool.Acquire(4096);
+  pool.Submit(file, true);
+  EXPECT_EQ(pool.Acquire(4096), nullptr);
+
+  pool.ReleaseAll();
+  EXPECT_EQ(pool.Acquire(4096), file);
+}
+
+TEST(FilePoolTest, UnlinksOnDestruction) {
+  std::string path;
+  {
+    FilePool pool;
+    path = pool.Acquire(4096)->path;
+    EXPECT_TRUE(Exists(path));
+  }
+  EXPECT_FALSE(Exists(path));
+}
+
+TEST(FilePoolTest, UnlinkRegistered) {
+  FilePool pool;
+  auto* file = pool.Acquire(4096);
+  UnlinkRegistered();
+  EXPECT_FALSE(Exists(file->path));
+}
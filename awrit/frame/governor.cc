@@ -0,0 +1,91 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "governor.h"
+
+namespace frame {
+
+namespace {
+const char* Name(FrameGovernor::State state) {
+  switch (state) {
+    case FrameGovernor::State::active:
+      return "active";
+    case FrameGovernor::State::idle:
+      return "idle";
+    default:
+      return "paused";
+  }
+}
+}  // namespace
+
+FrameGovernor::FrameGovernor(const GovernorOptions& options,
+                             Clock::time_point now)
+    : options_(options), last_activity_(now) {}
+
+bool FrameGovernor::Input(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return Activity(now);
+}
+
+bool FrameGovernor::Painted(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto previous = last_paint_;
+  last_paint_ = now;
+  if (state_ == State::paused) return Activity(now);
+  // paints in back to back ticks, with some slack for a late tick
+  if (now - previous > 2 * Interval(state_)) return false;
+  return Activity(now);
+}
+
+bool FrameGovernor::Activity(Clock::time_point now) {
+  if (now > last_activity_) last_activity_ = now;
+  bool raised = state_ != State::active;
+  state_ = State::active;
+  return raised;
+}
+
+FrameGovernor::State FrameGovernor::Tick(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto quiet = now - last_activity_;
+  if (options_.pause_after.count() > 0 && quiet >= options_.pause_after) {
+    state_ = State::paused;
+  } else if (quiet >= options_.idle_after) {
+    state_ = State::idle;
+  } else {
+    state_ = State::active;
+  }
+  ++ticks_[static_cast<int>(state_)];
+  return state_;
+}
+
+FrameGovernor::Clock::duration FrameGovernor::Interval(State state) const {
+  switch (state) {
+    case State::active:
+      return options_.active_interval;
+    case State::idle:
+      return options_.idle_interval;
+    default:
+      return options_.paused_interval;
+  }
+}
+
+FrameGovernor::State FrameGovernor::state() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return state_;
+}
+
+uint64_t FrameGovernor::ticks(State state) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return ticks_[static_cast<int>(state)];
+}
+
+std::string FrameGovernor::Format() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return std::string("governor=") + Name(state_) +
+         " active_ticks=" + std::to_string(ticks_[0]) +
+         " idle_ticks=" + std::to_string(ticks_[1]) +
+         " paused_ticks=" + std::to_string(ticks_[2]);
+}
+
+}  // namespace frame
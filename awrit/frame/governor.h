@@ -0,0 +1,84 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_GOVERNOR_H
+#define AWRIT_FRAME_GOVERNOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+namespace frame {
+
+struct GovernorOptions {
+  using Clock = std::chrono::steady_clock;
+
+  // how often frames are asked for while the page is in use
+  Clock::duration active_interval = std::chrono::milliseconds(25);
+  // how often frames are asked for once the page has been quiet for a while,
+  // which still picks up clocks, tickers and the like
+  Clock::duration idle_interval = std::chrono::milliseconds(500);
+  // quiet time before dropping to |idle_interval|
+  Clock::duration idle_after = std::chrono::seconds(2);
+  // quiet time before dropping to |paused_interval|, zero never pauses
+  Clock::duration pause_after = std::chrono::seconds(30);
+  // how often frames are asked for while paused. With external begin frames
+  // Chromium only paints when asked, so this is what lets a page that updates
+  // itself, like a chat or a feed, show its changes without input.
+  Clock::duration paused_interval = std::chrono::seconds(2);
+};
+
+// Decides how often Chromium is asked for a frame. Input and running
+// animations keep the rate up, while a page nobody touches and that stopped
+// changing drops to a trickle and is then paused, when it is only asked for a
+// frame every |paused_interval|.
+//
+// A single paint, such as a blinking caret, is not an animation. Paints only
+// count as activity when they follow each other tick after tick, or when they
+// arrive while paused.
+//
+// Activity is reported from the input and UI threads, the rate is read on the
+// UI thread.
+class FrameGovernor {
+ public:
+  using Clock = GovernorOptions::Clock;
+
+  enum class State { active, idle, paused };
+
+  explicit FrameGovernor(const GovernorOptions& options = {},
+                         Clock::time_point now = Clock::now());
+
+  // Input arrived. Returns true when this raised the rate, the caller then has
+  // to ask for a frame right away instead of waiting out the slower interval.
+  bool Input(Clock::time_point now = Clock::now());
+  // Chromium painted a frame, returns true like Input
+  bool Painted(Clock::time_point now = Clock::now());
+  // Moves to the state for the quiet time up to |now| and counts a tick
+  State Tick(Clock::time_point now = Clock::now());
+  // Time until the next tick in |state|
+  Clock::duration Interval(State state) const;
+
+  State state();
+  // ticks per state since the start, to compare wakeups with and without
+  // the governor
+  uint64_t ticks(State state);
+
+  // Formats the state and ticks as a single logfmt line
+  std::string Format();
+
+ private:
+  const GovernorOptions options_;
+  std::mutex mutex_;
+  State state_ = State::active;
+  Clock::time_point last_activity_;
+  Clock::time_point last_paint_;
+  uint64_t ticks_[3] = {};
+
+  bool Activity(Clock::time_point now);
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_GOVERNOR_H
@@ -0,0 +1,117 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "governor.h"
+
+#include <gtest/gtest.h>
+
+using namespace frame;
+using std::chrono::milliseconds;
+using State = FrameGovernor::State;
+
+namespace {
+GovernorOptions TestOptions() {
+  GovernorOptions options;
+  options.active_interval = milliseconds(25);
+  options.idle_interval = milliseconds(500);
+  options.idle_after = milliseconds(1000);
+  options.pause_after = milliseconds(5000);
+  return options;
+}
+}  // namespace
+
+TEST(FrameGovernorTest, SlowsDownWhenQuiet) {
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(TestOptions(), start);
+
+  EXPECT_EQ(governor.Tick(start + milliseconds(999)), State::active);
+  EXPECT_EQ(governor.Tick(start + milliseconds(1000)), State::idle);
+  EXPECT_EQ(governor.Tick(start + milliseconds(4999)), State::idle);
+  EXPECT_EQ(governor.Tick(start + milliseconds(5000)), State::paused);
+
+  EXPECT_EQ(governor.ticks(State::active), 1u);
+  EXPECT_EQ(governor.ticks(State::idle), 2u);
+  EXPECT_EQ(governor.ticks(State::paused), 1u);
+}
+
+TEST(FrameGovernorTest, ActivityWakesUp) {
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(TestOptions(), start);
+
+  // already active, the running ticks keep up
+  EXPECT_FALSE(governor.Input(start + milliseconds(10)));
+
+  EXPECT_EQ(governor.Tick(start + milliseconds(6000)), State::paused);
+  EXPECT_TRUE(governor.Input(start + milliseconds(6000)));
+  EXPECT_EQ(governor.state(), State::active);
+  EXPECT_EQ(governor.Tick(start + milliseconds(6025)), State::active);
+
+  EXPECT_EQ(governor.Tick(start + milliseconds(7000)), State::idle);
+  EXPECT_TRUE(governor.Input(start + milliseconds(7100)));
+  EXPECT_EQ(governor.Tick(start + milliseconds(7125)), State::active);
+}
+
+TEST(FrameGovernorTest, AnimationsKeepUp) {
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(TestOptions(), start);
+
+  // a lone paint, like a blinking caret, is not an animation
+  EXPECT_EQ(governor.Tick(start + milliseconds(1000)), State::idle);
+  EXPECT_FALSE(governor.Painted(start + milliseconds(1000)));
+  EXPECT_EQ(governor.Tick(start + milliseconds(2500)), State::idle);
+
+  // but paints in consecutive ticks are
+  EXPECT_FALSE(governor.Painted(start + milliseconds(3000)));
+  EXPECT_TRUE(governor.Painted(start + milliseconds(3500)));
+  EXPECT_EQ(governor.Tick(start + milliseconds(3525)), State::active);
+  EXPECT_FALSE(governor.Painted(start + milliseconds(3525)));
+  EXPECT_EQ(governor.Tick(start + milliseconds(4520)), State::active);
+}
+
+TEST(FrameGovernorTest, PaintsWakeUp) {
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(TestOptions(), start);
+
+  EXPECT_EQ(governor.Tick(start + milliseconds(6000)), State::paused);
+  EXPECT_TRUE(governor.Painted(start + milliseconds(6000)));
+  EXPECT_EQ(governor.state(), State::active);
+}
+
+TEST(FrameGovernorTest, Formats) {
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(TestOptions(), start);
+  governor.Tick(start);
+  governor.Tick(start + milliseconds(1000));
+  EXPECT_EQ(governor.Format(),
+            "governor=idle active_ticks=1 idle_ticks=1 paused_ticks=0");
+}
+
+TEST(FrameGovernorTest, NeverPausesWithoutPauseTime) {
+  auto options = TestOptions();
+  options.pause_after = {};
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(options, start);
+
+  EXPECT_EQ(governor.Tick(start + std::chrono::hours(1)), State::idle);
+}
+
+TEST(FrameGovernorTest, Intervals) {
+  FrameGovernor governor(TestOptions());
+  EXPECT_EQ(governor.Interval(State::active), milliseconds(25));
+  EXPECT_EQ(governor.Interval(State::idle), milliseconds(500));
+  EXPECT_EQ(governor.Interval(State::paused), std::chrono::seconds(2));
+}
+
+TEST(FrameGovernorTest, KeepsTickingWhilePaused) {
+  const auto start = FrameGovernor::Clock::now();
+  FrameGovernor governor(TestOptions(), start);
+  ASSERT_EQ(governor.Tick(start + milliseconds(5000)), State::paused);
+  // a paint can only follow a tick, so paused must still have a next one
+  auto interval = governor.Interval(State::paused);
+  EXPECT_GT(interval, FrameGovernor::Clock::duration::zero());
+  EXPECT_LT(interval, std::chrono::minutes(1));
+  // and a paint it asked for wakes the governor up
+  EXPECT_TRUE(governor.Painted(start + milliseconds(5000) + interval));
+  EXPECT_EQ(governor.state(), State::active);
+}
@@ -0,0 +1,260 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "journal.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "compress.h"
+
+namespace frame {
+
+namespace {
+constexpr size_t kBytesPerPixel = 4;
+// a sanity limit for the size of a recorded frame
+constexpr int kMaxDimension = 1 << 15;
+
+constexpr size_t Align8(size_t size) { return (size + 7) & ~size_t(7); }
+
+// XORs |size| bytes of |src| into |dest|
+void Xor(uint8_t* dest, const uint8_t* src, size_t size) {
+  for (size_t i = 0; i < size; ++i) dest[i] ^= src[i];
+}
+
+bool WritePadded(FILE* file, const void* data, size_t size) {
+  static const char kZeros[8] = {};
+  return fwrite(data, 1, size, file) == size &&
+         fwrite(kZeros, 1, Align8(size) - size, file) == Align8(size) - size;
+}
+}  // namespace
+
+JournalWriter::~JournalWriter() { Close(); }
+
+bool JournalWriter::Open(const std::string& path) {
+  Close();
+  file_ = fopen(path.c_str(), "wb");
+  if (!file_) {
+    fprintf(stderr, "Failed to open journal %s: %s\r\n", path.c_str(),
+            strerror(errno));
+    return false;
+  }
+  JournalHeader header;
+  if (fwrite(&header, sizeof(header), 1, file_) != 1) {
+    fclose(file_);
+    file_ = nullptr;
+    return false;
+  }
+  worker_ = std::make_unique<Worker>();
+  previous_.clear();
+  size_ = {};
+  failed_ = false;
+  return true;
+}
+
+void JournalWriter::Write(const void* pixels, Size size,
+                          const std::vector<Rect>& dirty,
+                          Clock::time_point time) {
+  if (!file_ || failed_) return;
+
+  const Rect bounds{0, 0, size.width, size.height};
+  const size_t stride = size.width * kBytesPerPixel;
+  JournalRecord record;
+  std::vector<Rect> rects;
+  if (previous_.empty()) start_ = time;
+  if (previous_.empty() || size != size_) {
+    size_ = size;
+    previous_.assign(stride * size.height, 0);
+    record.flags |= JournalRecord::keyframe;
+    rects.push_back(bounds);
+  } else {
+    for (const auto& rect : dirty) {
+      auto clipped = rect.Intersect(bounds);
+      if (!clipped.IsEmpty()) rects.push_back(clipped);
+    }
+  }
+
+  // rects are applied in order, so where they overlap the later ones find
+  // the pixels already updated and store zeros
+  size_t raw_size = 0;
+  for (const auto& rect : rects) raw_size += rect.Area() * kBytesPerPixel;
+  std::vector<uint8_t> delta(raw_size);
+  uint8_t* out = delta.data();
+  const auto* src = static_cast<const uint8_t*>(pixels);
+  for (const auto& rect : rects) {
+    const size_t row_bytes = rect.width * kBytesPerPixel;
+    for (int y = rect.y; y < rect.Bottom(); ++y) {
+      const size_t offset = y * stride + rect.x * kBytesPerPixel;
+      memcpy(out, src + offset, row_bytes);
+      Xor(out, previous_.data() + offset, row_bytes);
+      memcpy(previous_.data() + offset, src + offset, row_bytes);
+      out += row_bytes;
+    }
+  }
+
+  record.time_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(time - start_)
+          .count();
+  record.width = size.width;
+  record.height = size.height;
+  record.rect_count = rects.size();
+  record.raw_size = raw_size;
+  worker_->Post([this, record, rects = std::move(rects),
+                 delta = std::move(delta)]() mutable {
+    const void* payload = delta.data();
+    record.payload_size = delta.size();
+    if (Compress(delta.data(), delta.size(), compressed_) &&
+        compressed_.size() < delta.size()) {
+      payload = compressed_.data();
+      record.payload_size = compressed_.size();
+      record.flags |= JournalRecord::compressed;
+    }
+
+    std::vector<int32_t> packed;
+    packed.reserve(rects.size() * 4);
+    for (const auto& rect : rects) {
+      packed.insert(packed.end(), {rect.x, rect.y, rect.width, rect.height});
+    }
+    if (!WritePadded(file_, &record, sizeof(record)) ||
+        !WritePadded(file_, packed.data(), packed.size() * sizeof(int32_t)) ||
+        !WritePadded(file_, payload, record.payload_size)) {
+      fprintf(stderr, "Failed to write journal: %s\r\n", strerror(errno));
+      failed_ = true;
+    }
+  });
+}
+
+void JournalWriter::Close() {
+  if (!file_) return;
+  worker_.reset();
+  fclose(file_);
+  file_ = nullptr;
+  previous_ = {};
+}
+
+JournalReader::~JournalReader() { Unmap(); }
+
+void JournalReader::Unmap() {
+  if (data_) munmap(const_cast<uint8_t*>(data_), size_);
+  data_ = nullptr;
+  size_ = 0;
+}
+
+bool JournalReader::Open(const std::string& path) {
+  Unmap();
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    fprintf(stderr, "Failed to open journal %s: %s\r\n", path.c_str(),
+            strerror(errno));
+    return false;
+  }
+  struct stat info;
+  void* data = MAP_FAILED;
+  if (fstat(fd, &info) == 0 && info.st_size >= 0 &&
+      static_cast<size_t>(info.st_size) >= sizeof(JournalHeader)) {
+    data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "Failed to map journal %s\r\n", path.c_str());
+    return false;
+  }
+  data_ = static_cast<const uint8_t*>(data);
+  size_ = info.st_size;
+  // frames are read once, front to back
+  madvise(data, size_, MADV_SEQUENTIAL);
+
+  const auto* header = reinterpret_cast<const JournalHeader*>(data_);
+  const JournalHeader expected;
+  if (memcmp(header->magic, expected.magic, sizeof(expected.magic)) != 0 ||
+      header->version != expected.version) {
+    fprintf(stderr, "Not a journal: %s\r\n", path.c_str());
+    Unmap();
+    return false;
+  }
+  Rewind();
+  return true;
+}
+
+void JournalReader::Rewind() {
+  offset_ = sizeof(JournalHeader);
+  frame_ = {};
+  time_us_ = 0;
+}
+
+bool JournalReader::Next() {
+  if (!data_ || size_ - offset_ < sizeof(JournalRecord)) return false;
+  // every part is padded to 8 bytes and the mapping is page aligned
+  const auto* record =
+      reinterpret_cast<const JournalRecord*>(data_ + offset_);
+  size_t offset = offset_ + sizeof(JournalRecord);
+
+  const bool keyframe = record->flags & JournalRecord::keyframe;
+  if (record->width <= 0 || record->height <= 0 ||
+      record->width > kMaxDimension || record->height > kMaxDimension) {
+    return false;
+  }
+  const Size size{record->width, record->height};
+  if (!keyframe && size != frame_.size) return false;
+
+  const size_t rects_size = size_t(record->rect_count) * 4 * sizeof(int32_t);
+  if (record->rect_count > size_ || Align8(rects_size) > size_ - offset)
+    return false;
+  const auto* packed = reinterpret_cast<const int32_t*>(data_ + offset);
+  offset += Align8(rects_size);
+  if (record->payload_size > size_ ||
+      Align8(record->payload_size) > size_ - offset)
+    return false;
+  const uint8_t* payload = data_ + offset;
+  offset += Align8(record->payload_size);
+
+  const Rect bounds{0, 0, size.width, size.height};
+  std::vector<Rect> rects;
+  rects.reserve(record->rect_count);
+  uint64_t raw_size = 0;
+  for (uint32_t i = 0; i < record->rect_count; ++i) {
+    Rect rect{packed[i * 4], packed[i * 4 + 1], packed[i * 4 + 2],
+              packed[i * 4 + 3]};
+    if (rect.IsEmpty() || rect.Intersect(bounds) != rect) return false;
+    raw_size += rect.Area() * kBytesPerPixel;
+    rects.push_back(rect);
+  }
+  if (raw_size != record->raw_size) return false;
+
+  const uint8_t* delta = payload;
+  if (record->flags & JournalRecord::compressed) {
+    delta_.resize(raw_size);
+    if (!Decompress(payload, record->payload_size, delta_.data(), raw_size))
+      return false;
+    delta = delta_.data();
+  } else if (record->payload_size != raw_size) {
+    return false;
+  }
+
+  const size_t stride = size.width * kBytesPerPixel;
+  if (keyframe) {
+    frame_.size = size;
+    frame_.pixels.assign(stride * size.height, 0);
+  }
+  for (const auto& rect : rects) {
+    const size_t row_bytes = rect.width * kBytesPerPixel;
+    for (int y = rect.y; y < rect.Bottom(); ++y) {
+      Xor(frame_.pixels.data() + y * stride + rect.x * kBytesPerPixel, delta,
+          row_bytes);
+      delta += row_bytes;
+    }
+  }
+  frame_.dirty = std::move(rects);
+  frame_.posted = std::chrono::steady_clock::now();
+  time_us_ = record->time_us;
+  offset_ = offset;
+  return true;
+}
+
+}  // namespace frame
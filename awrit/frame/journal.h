@@ -0,0 +1,130 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_JOURNAL_H
+#define AWRIT_FRAME_JOURNAL_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "mailbox.h"
+#include "rect.h"
+#include "worker.h"
+
+namespace frame {
+
+// A journal is a recording of the frames a page rendered, for replaying a
+// session while tuning the paint pipeline. It is laid out to be read in place
+// from a mapping, in the byte order of the machine that wrote it:
+//
+//   JournalHeader
+//   for every frame, each part padded to 8 bytes:
+//     JournalRecord
+//     |rect_count| x int32_t[4] dirty rects as x, y, width, height
+//     |payload_size| bytes of payload
+//
+// The payload holds the pixels under the dirty rects, rect after rect and row
+// after row, XORed with the same pixels of the previous frame so that whatever
+// did not change is zero. It is zlib compressed unless that did not make it
+// smaller, uncompressed payloads are applied straight from the mapping.
+struct JournalHeader {
+  char magic[8] = {'A', 'W', 'R', 'I', 'T', 'J', 'N', 'L'};
+  uint32_t version = 1;
+  uint32_t reserved = 0;
+};
+
+struct JournalRecord {
+  enum Flags : uint32_t {
+    // the payload is zlib compressed
+    compressed = 1 << 0,
+    // the frame starts over from black, as the first frame and any frame of a
+    // different size do
+    keyframe = 1 << 1,
+  };
+
+  // since the first frame
+  int64_t time_us = 0;
+  int32_t width = 0;
+  int32_t height = 0;
+  uint32_t rect_count = 0;
+  uint32_t flags = 0;
+  // bytes of the uncompressed payload
+  uint64_t raw_size = 0;
+  uint64_t payload_size = 0;
+};
+
+// Appends frames to a journal. Deltas are taken on the calling thread, since
+// the frame's buffer is only valid until Write returns, compressing and
+// writing them is left to a worker.
+class JournalWriter {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  JournalWriter() = default;
+  ~JournalWriter();
+
+  JournalWriter(const JournalWriter&) = delete;
+  JournalWriter& operator=(const JournalWriter&) = delete;
+
+  bool Open(const std::string& path);
+  // Records the |dirty| rects of the BGRA |pixels|
+  void Write(const void* pixels, Size size, const std::vector<Rect>& dirty,
+             Clock::time_point time = Clock::now());
+  // Writes out every recorded frame and closes the file
+  void Close();
+
+ private:
+  FILE* file_ = nullptr;
+  std::unique_ptr<Worker> worker_;
+  // the frame as the journal has it so far
+  std::vector<uint8_t> previous_;
+  Size size_;
+  Clock::time_point start_;
+  // only touched by |worker_|
+  std::string compressed_;
+  std::atomic<bool> failed_{false};
+};
+
+// Reads a journal from a mapping, rebuilding each frame in turn
+class JournalReader {
+ public:
+  JournalReader() = default;
+  ~JournalReader();
+
+  JournalReader(const JournalReader&) = delete;
+  JournalReader& operator=(const JournalReader&) = delete;
+
+  bool Open(const std::string& path);
+  // Applies the next record to frame(), returns false at the end of the
+  // journal or at a record that is cut short or inconsistent
+  bool Next();
+  // Starts over at the first frame
+  void Rewind();
+
+  // the current frame, |dirty| holds the rects of its record and |posted|
+  // the time it was read
+  const FrameMailbox::Frame& frame() const { return frame_; }
+  int64_t time_us() const { return time_us_; }
+
+ private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t offset_ = 0;
+  FrameMailbox::Frame frame_;
+  int64_t time_us_ = 0;
+  // inflated payloads, reused between records
+  std::vector<uint8_t> delta_;
+
+  void Unmap();
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_JOURNAL_H
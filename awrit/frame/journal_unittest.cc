@@ -0,0 +1,142 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "journal.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace frame;
+
+namespace {
+class JournalTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    char path[] = "/tmp/awrit-journal-XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_GE(fd, 0);
+    close(fd);
+    path_ = path;
+  }
+  void TearDown() override { unlink(path_.c_str()); }
+
+  std::string path_;
+};
+
+void Paint(std::vector<uint8_t>& pixels, Size size, const Rect& rect,
+           uint32_t color) {
+  auto* px = reinterpret_cast<uint32_t*>(pixels.data());
+  for (int y = rect.y; y < rect.Bottom(); ++y) {
+    for (int x = rect.x; x < rect.Right(); ++x) {
+      px[y * size.width + x] = color + x;
+    }
+  }
+}
+}  // namespace
+
+TEST_F(JournalTest, RoundTrips) {
+  using namespace std::chrono_literals;
+  const Size size{64, 48};
+  std::vector<uint8_t> pixels(size.width * size.height * 4);
+  Paint(pixels, size, {0, 0, 64, 48}, 0xff203040);
+
+  std::vector<std::vector<uint8_t>> frames;
+  std::vector<std::vector<Rect>> dirty;
+  const std::vector<Rect> changes[] = {
+      {{0, 0, 64, 48}},
+      {{8, 8, 16, 16}},
+      // overlapping, and one reaching past the frame
+      {{10, 10, 20, 20}, {20, 20, 60, 60}},
+      {}};
+  JournalWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  auto start = JournalWriter::Clock::now();
+  for (size_t i = 0; i < std::size(changes); ++i) {
+    for (const auto& rect : changes[i]) {
+      Paint(pixels, size, rect.Intersect({0, 0, 64, 48}), 0xff000000 + i * 99);
+    }
+    writer.Write(pixels.data(), size, changes[i], start + i * 16ms);
+    frames.push_back(pixels);
+  }
+  writer.Close();
+
+  JournalReader reader;
+  ASSERT_TRUE(reader.Open(path_));
+  for (size_t i = 0; i < frames.size(); ++i) {
+    ASSERT_TRUE(reader.Next()) << "frame " << i;
+    EXPECT_EQ(reader.time_us(), static_cast<int64_t>(i * 16000));
+    EXPECT_EQ(reader.frame().size, size);
+    EXPECT_EQ(reader.frame().pixels, frames[i]) << "frame " << i;
+  }
+  EXPECT_EQ(reader.frame().dirty.size(), 0u);
+  EXPECT_FALSE(reader.Next());
+
+  reader.Rewind();
+  ASSERT_TRUE(reader.Next());
+  EXPECT_EQ(reader.frame().pixels, frames[0]);
+}
+
+TEST_F(JournalTest, Resizes) {
+  JournalWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  std::vector<uint8_t> small(8 * 8 * 4, 1), large(16 * 4 * 4, 2);
+  writer.Write(small.data(), {8, 8}, {});
+  writer.Write(large.data(), {16, 4}, {{0, 0, 1, 1}});
+  writer.Close();
+
+  JournalReader reader;
+  ASSERT_TRUE(reader.Open(path_));
+  ASSERT_TRUE(reader.Next());
+  ASSERT_TRUE(reader.Next());
+  EXPECT_EQ(reader.frame().size, (Size{16, 4}));
+  EXPECT_EQ(reader.frame().pixels, large);
+  ASSERT_EQ(reader.frame().dirty.size(), 1u);
+  EXPECT_EQ(reader.frame().dirty[0], (Rect{0, 0, 16, 4}));
+}
+
+TEST_F(JournalTest, KeepsNoiseUncompressed) {
+  const Size size{32, 32};
+  std::vector<uint8_t> pixels(size.width * size.height * 4);
+  std::mt19937 engine(7);
+  for (auto& byte : pixels) byte = engine();
+
+  JournalWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  writer.Write(pixels.data(), size, {});
+  writer.Close();
+
+  JournalReader reader;
+  ASSERT_TRUE(reader.Open(path_));
+  ASSERT_TRUE(reader.Next());
+  EXPECT_EQ(reader.frame().pixels, pixels);
+}
+
+TEST_F(JournalTest, StopsAtTruncatedRecord) {
+  const Size size{32, 32};
+  std::vector<uint8_t> pixels(size.width * size.height * 4, 5);
+  JournalWriter writer;
+  ASSERT_TRUE(writer.Open(path_));
+  writer.Write(pixels.data(), size, {});
+  pixels[0] = 9;
+  writer.Write(pixels.data(), size, {{0, 0, 1, 1}});
+  writer.Close();
+  ASSERT_EQ(truncate(path_.c_str(), sizeof(JournalHeader) + 60), 0);
+
+  JournalReader reader;
+  ASSERT_TRUE(reader.Open(path_));
+  EXPECT_FALSE(reader.Next());
+}
+
+TEST_F(JournalTest, RejectsOtherFiles) {
+  FILE* file = fopen(path_.c_str(), "w");
+  fputs("definitely not a journal", file);
+  fclose(file);
+  JournalReader reader;
+  EXPECT_FALSE(reader.Open(path_));
+}
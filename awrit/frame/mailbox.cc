@@ -0,0 +1,125 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "mailbox.h"
+
+#include <cstring>
+
+namespace frame {
+
+namespace {
+
+// past this many rects a list is collapsed into its bounding rect, copying a
+// little more beats walking an ever longer list
+constexpr size_t kMaxRects = 32;
+
+void AddRects(std::vector<Rect>& rects, const std::vector<Rect>& more) {
+  rects.insert(rects.end(), more.begin(), more.end());
+  if (rects.size() <= kMaxRects) return;
+
+  Rect bounds;
+  for (const auto& rect : rects) bounds = bounds.Union(rect);
+  rects.assign(1, bounds);
+}
+
+void CopyRect(const void* src, void* dest, Size size, const Rect& rect) {
+  Rect clipped = rect.Intersect({0, 0, size.width, size.height});
+  if (clipped.IsEmpty()) return;
+
+  const size_t stride = static_cast<size_t>(size.width) * 4;
+  const size_t offset = clipped.y * stride + clipped.x * 4;
+  const size_t row_bytes = static_cast<size_t>(clipped.width) * 4;
+  auto* from = static_cast<const uint8_t*>(src) + offset;
+  auto* to = static_cast<uint8_t*>(dest) + offset;
+  for (int row = 0; row < clipped.height; ++row) {
+    memcpy(to, from, row_bytes);
+    from += stride;
+    to += stride;
+  }
+}
+
+}  // namespace
+
+void FrameMailbox::Post(const void* pixels, Size size,
+                        const std::vector<Rect>& dirty) {
+  int index = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) return;
+    while (index == waiting_ || index == taken_) ++index;
+  }
+
+  // the buffer is neither waiting nor taken, so only this thread touches it
+  auto& buffer = buffers_[index];
+  const Rect bounds{0, 0, size.width, size.height};
+  if (buffer.frame.size != size) {
+    buffer.frame.pixels.resize(bounds.Area() * 4);
+    buffer.stale.assign(1, bounds);
+  }
+  AddRects(buffer.stale, dirty);
+  for (const auto& rect : buffer.stale) {
+    CopyRect(pixels, buffer.frame.pixels.data(), size, rect);
+  }
+  buffer.stale.clear();
+
+  // |stale| is only ever touched by the posting thread
+  for (int i = 0; i < kBuffers; ++i) {
+    if (i != index) AddRects(buffers_[i].stale, dirty);
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  buffer.frame.size = size;
+  buffer.frame.dirty = dirty;
+  buffer.frame.dropped = 0;
+  buffer.frame.posted = std::chrono::steady_clock::now();
+  if (waiting_ >= 0) {
+    const auto& replaced = buffers_[waiting_].frame;
+    AddRects(buffer.frame.dirty, replaced.dirty);
+    buffer.frame.dropped = replaced.dropped + 1;
+    ++dropped_frames_;
+  }
+  waiting_ = index;
+  posted_.notify_one();
+}
+
+const FrameMailbox::Frame* FrameMailbox::Take() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  taken_ = -1;
+  posted_.wait(lock, [this] { return closed_ || woken_ || waiting_ >= 0; });
+  woken_ = false;
+  if (closed_ || waiting_ < 0) return nullptr;
+
+  taken_ = waiting_;
+  waiting_ = -1;
+  return &buffers_[taken_].frame;
+}
+
+void FrameMailbox::WakeUp() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    woken_ = true;
+  }
+  posted_.notify_one();
+}
+
+bool FrameMailbox::closed() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return closed_;
+}
+
+void FrameMailbox::Close() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    waiting_ = -1;
+  }
+  posted_.notify_all();
+}
+
+uint64_t FrameMailbox::dropped_frames() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return dropped_frames_;
+}
+
+}  // namespace frame
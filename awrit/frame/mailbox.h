@@ -0,0 +1,82 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_MAILBOX_H
+#define AWRIT_FRAME_MAILBOX_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "rect.h"
+
+namespace frame {
+
+// Hands frames from the thread that renders them to the thread that paints
+// them. Only the newest frame waits: posting replaces a frame that has not
+// been taken yet and folds its damage into the new one, so a slow terminal
+// costs dropped frames instead of a growing queue.
+//
+// Frames are copied into three pooled buffers, enough for one being written,
+// one waiting and one being painted. Each buffer remembers what changed since
+// it was last written, so a post only copies that and the new damage.
+class FrameMailbox {
+ public:
+  struct Frame {
+    Size size;
+    // BGRA, |size.width| * 4 bytes per row
+    std::vector<uint8_t> pixels;
+    // damage since the previously taken frame
+    std::vector<Rect> dirty;
+    // frames that were replaced by this one before being taken
+    uint32_t dropped = 0;
+    std::chrono::steady_clock::time_point posted;
+  };
+
+  FrameMailbox() = default;
+  FrameMailbox(const FrameMailbox&) = delete;
+  FrameMailbox& operator=(const FrameMailbox&) = delete;
+
+  // Copies the |dirty| rects of the BGRA |pixels| into a pooled frame and
+  // makes it the waiting one. Only one thread may post.
+  void Post(const void* pixels, Size size, const std::vector<Rect>& dirty);
+
+  // Blocks until a frame is waiting and returns it, it stays valid until the
+  // next call. Returns nullptr once the mailbox is closed, or when woken up
+  // without a frame waiting.
+  const Frame* Take();
+
+  // Wakes up Take once, for work the painting thread has besides frames
+  void WakeUp();
+  // Wakes up Take for good, a waiting frame is discarded
+  void Close();
+  bool closed();
+
+  // frames replaced before they were taken since the mailbox was created
+  uint64_t dropped_frames();
+
+ private:
+  struct Buffer {
+    Frame frame;
+    // areas of |frame.pixels| that are older than the last posted frame
+    std::vector<Rect> stale;
+  };
+
+  static constexpr int kBuffers = 3;
+
+  std::mutex mutex_;
+  std::condition_variable posted_;
+  Buffer buffers_[kBuffers];
+  int waiting_ = -1;
+  int taken_ = -1;
+  bool woken_ = false;
+  bool closed_ = false;
+  uint64_t dropped_frames_ = 0;
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_MAILBOX_H
@@ -0,0 +1,130 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "mailbox.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+using namespace frame;
+
+namespace {
+// BGRA pixels of |size|, every byte set to |value|
+std::vector<uint8_t> Fill(Size size, uint8_t value) {
+  return std::vector<uint8_t>(size.width * size.height * 4, value);
+}
+
+void Paint(std::vector<uint8_t>& pixels, Size size, const Rect& rect,
+           uint8_t value) {
+  for (int y = rect.y; y < rect.Bottom(); ++y) {
+    for (int x = rect.x; x < rect.Right(); ++x) {
+      for (int c = 0; c < 4; ++c) pixels[(y * size.width + x) * 4 + c] = value;
+    }
+  }
+}
+}  // namespace
+
+TEST(FrameMailboxTest, KeepsOnlyTheNewestFrame) {
+  const Size size{8, 8};
+  FrameMailbox mailbox;
+  auto pixels = Fill(size, 1);
+  mailbox.Post(pixels.data(), size, {{0, 0, 8, 8}});
+  Paint(pixels, size, {0, 0, 2, 2}, 2);
+  mailbox.Post(pixels.data(), size, {{0, 0, 2, 2}});
+  Paint(pixels, size, {4, 4, 2, 2}, 3);
+  mailbox.Post(pixels.data(), size, {{4, 4, 2, 2}});
+
+  auto* frame = mailbox.Take();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->dropped, 2u);
+  EXPECT_EQ(mailbox.dropped_frames(), 2u);
+  // the damage of the dropped frames is carried over
+  ASSERT_EQ(frame->dirty.size(), 3u);
+  EXPECT_EQ(frame->dirty[0], (Rect{4, 4, 2, 2}));
+  EXPECT_EQ(frame->dirty[1], (Rect{0, 0, 2, 2}));
+  EXPECT_EQ(frame->dirty[2], (Rect{0, 0, 8, 8}));
+  EXPECT_EQ(frame->pixels, pixels);
+}
+
+TEST(FrameMailboxTest, CopiesOnlyWhatChanged) {
+  const Size size{16, 16};
+  FrameMailbox mailbox;
+  auto pixels = Fill(size, 0);
+  mailbox.Post(pixels.data(), size, {{0, 0, 16, 16}});
+  ASSERT_NE(mailbox.Take(), nullptr);
+
+  // every buffer gets written a few times, each frame only damages a corner
+  for (uint8_t i = 1; i < 10; ++i) {
+    Rect rect{i % 2 * 8, i % 3 * 4, 8, 4};
+    Paint(pixels, size, rect, i);
+    mailbox.Post(pixels.data(), size, {rect});
+    auto* frame = mailbox.Take();
+    ASSERT_NE(frame, nullptr);
+    EXPECT_EQ(frame->dropped, 0u);
+    EXPECT_EQ(frame->pixels, pixels) << "frame " << int{i};
+  }
+}
+
+TEST(FrameMailboxTest, Resizes) {
+  FrameMailbox mailbox;
+  auto small = Fill({4, 4}, 1);
+  mailbox.Post(small.data(), {4, 4}, {{0, 0, 4, 4}});
+  ASSERT_NE(mailbox.Take(), nullptr);
+
+  // damage only covers part of the new size, the rest is copied anyway
+  auto large = Fill({8, 6}, 2);
+  mailbox.Post(large.data(), {8, 6}, {{0, 0, 1, 1}});
+  auto* frame = mailbox.Take();
+  ASSERT_NE(frame, nullptr);
+  EXPECT_EQ(frame->size, (Size{8, 6}));
+  EXPECT_EQ(frame->pixels, large);
+}
+
+TEST(FrameMailboxTest, CloseWakesTake) {
+  FrameMailbox mailbox;
+  std::thread painter([&mailbox] { EXPECT_EQ(mailbox.Take(), nullptr); });
+  mailbox.Close();
+  painter.join();
+}
+
+TEST(FrameMailboxTest, WakeUpWithoutFrame) {
+  FrameMailbox mailbox;
+  std::thread painter([&mailbox] {
+    EXPECT_EQ(mailbox.Take(), nullptr);
+    EXPECT_FALSE(mailbox.closed());
+  });
+  mailbox.WakeUp();
+  painter.join();
+
+  // a waiting frame is still handed over
+  const Size size{2, 2};
+  auto pixels = Fill(size, 1);
+  mailbox.Post(pixels.data(), size, {{0, 0, 2, 2}});
+  mailbox.WakeUp();
+  ASSERT_NE(mailbox.Take(), nullptr);
+  mailbox.Close();
+  EXPECT_TRUE(mailbox.closed());
+}
+
+TEST(FrameMailboxTest, PaintsWhilePosting) {
+  const Size size{32, 32};
+  FrameMailbox mailbox;
+  std::thread painter([&mailbox, size] {
+    while (auto* frame = mailbox.Take()) {
+      // every frame is a solid color, a torn frame would mix two of them
+      for (auto byte : frame->pixels) ASSERT_EQ(byte, frame->pixels[0]);
+      EXPECT_EQ(frame->size, size);
+    }
+  });
+
+  for (int i = 0; i < 1000; ++i) {
+    auto pixels = Fill(size, i % 256);
+    mailbox.Post(pixels.data(), size, {{0, 0, 32, 32}});
+  }
+  mailbox.Close();
+  painter.join();
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "metrics.h"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+
+namespace frame {
+
+size_t Histogram::BucketFor(int64_t value) {
+  if (value <= 1) return 0;
+  // buckets are closed above, so they are found from one less than the value
+  uint64_t n = value - 1;
+  if (n < 4) return n;
+  int exponent = 63 - __builtin_clzll(n);
+  size_t sub = (n >> (exponent - 2)) & 3;
+  size_t bucket = 4 + (exponent - 2) * 4 + sub;
+  return bucket < kBuckets ? bucket : kBuckets - 1;
+}
+
+uint64_t Histogram::UpperBound(size_t bucket) {
+  if (bucket < 4) return bucket + 1;
+  size_t exponent = (bucket - 4) / 4 + 2;
+  size_t sub = (bucket - 4) % 4;
+  return static_cast<uint64_t>(5 + sub) << (exponent - 2);
+}
+
+void Histogram::Record(int64_t value) {
+  buckets_[BucketFor(value)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value > 0 ? value : 0, std::memory_order_relaxed);
+}
+
+uint64_t Histogram::CountAtMost(int64_t value) const {
+  uint64_t total = 0;
+  for (size_t i = 0; i < kBuckets && UpperBound(i) <= uint64_t(value); ++i) {
+    total += buckets_[i].load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t Histogram::Percentile(double quantile) const {
+  uint64_t total = count();
+  if (total == 0) return 0;
+  // the rank of the value, counted from 1
+  uint64_t rank = std::max<uint64_t>(1, quantile * total + 0.5);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < kBuckets; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) return UpperBound(i);
+  }
+  return UpperBound(kBuckets - 1);
+}
+
+namespace metrics {
+
+namespace internal {
+std::atomic<bool> enabled{false};
+}  // namespace internal
+
+namespace {
+// exported bucket bounds, in microseconds: 16us to about 33s
+constexpr int kFirstBound = 4;
+constexpr int kLastBound = 25;
+
+struct Registry {
+  std::array<Histogram, static_cast<size_t>(Stage::count)> stages;
+  std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::count)>
+      counters{};
+};
+
+Registry& GetRegistry() {
+  static Registry registry;
+  return registry;
+}
+
+__attribute__((format(printf, 2, 3))) void Append(std::string& out,
+                                                  const char* format, ...) {
+  char line[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(line, sizeof(line), format, args);
+  va_end(args);
+  if (length > 0) out.append(line, std::min<size_t>(length, sizeof(line) - 1));
+}
+}  // namespace
+
+namespace internal {
+void Record(Stage stage, int64_t us) {
+  GetRegistry().stages[static_cast<size_t>(stage)].Record(us);
+}
+
+void Add(Counter counter, uint64_t value) {
+  GetRegistry().counters[static_cast<size_t>(counter)].fetch_add(
+      value, std::memory_order_relaxed);
+}
+}  // namespace internal
+
+void Enable(bool enable) {
+  internal::enabled.store(enable, std::memory_order_relaxed);
+}
+
+const char* StageName(Stage stage) {
+  switch (stage) {
+    case Stage::paint:
+      return "paint";
+    case Stage::convert:
+      return "convert";
+    case Stage::shm:
+      return "shm";
+    case Stage::file:
+      return "file";
+    case Stage::compress:
+      return "compress";
+    case Stage::enqueue:
+      return "enqueue";
+    case Stage::tty_write:
+      return "tty_write";
+    case Stage::frame_wait:
+      return "frame_wait";
+    default:
+      return "unknown";
+  }
+}
+
+const char* CounterName(Counter counter) {
+  switch (counter) {
+    case Counter::frames_painted:
+      return "awrit_frames_painted_total";
+    case Counter::frames_dropped:
+      return "awrit_frames_dropped_total";
+    case Counter::pixel_bytes:
+      return "awrit_pixel_bytes_total";
+    case Counter::tty_bytes:
+      return "awrit_tty_bytes_total";
+    default:
+      return "unknown";
+  }
+}
+
+const Histogram& GetHistogram(Stage stage) {
+  return GetRegistry().stages[static_cast<size_t>(stage)];
+}
+
+uint64_t GetCounter(Counter counter) {
+  return GetRegistry().counters[static_cast<size_t>(counter)].load(
+      std::memory_order_relaxed);
+}
+
+std::string FormatPrometheus() {
+  std::string out =
+      "# HELP awrit_stage_duration_seconds Time spent in each stage of the "
+      "frame pipeline\n"
+      "# TYPE awrit_stage_duration_seconds histogram\n";
+  for (size_t i = 0; i < static_cast<size_t>(Stage::count); ++i) {
+    auto stage = static_cast<Stage>(i);
+    const char* name = StageName(stage);
+    const auto& histogram = GetHistogram(stage);
+    // read first, so that no bucket is above it while frames are recorded
+    uint64_t count = histogram.count();
+    for (int bound = kFirstBound; bound <= kLastBound; ++bound) {
+      uint64_t us = uint64_t(1) << bound;
+      uint64_t at_most = histogram.CountAtMost(us);
+      Append(out,
+             "awrit_stage_duration_seconds_bucket{stage=\"%s\",le=\"%.9g\"} "
+             "%llu\n",
+             name, us / 1e6,
+             static_cast<unsigned long long>(at_most < count ? at_most
+                                                             : count));
+    }
+    Append(out,
+           "awrit_stage_duration_seconds_bucket{stage=\"%s\",le=\"+Inf\"} "
+           "%llu\n",
+           name, static_cast<unsigned long long>(count));
+    Append(out, "awrit_stage_duration_seconds_sum{stage=\"%s\"} %.9g\n", name,
+           histogram.sum() / 1e6);
+    Append(out, "awrit_stage_duration_seconds_count{stage=\"%s\"} %llu\n",
+           name, static_cast<unsigned long long>(count));
+  }
+  for (size_t i = 0; i < static_cast<size_t>(Counter::count); ++i) {
+    auto counter = static_cast<Counter>(i);
+    out += "# TYPE ";
+    out += CounterName(counter);
+    out += " counter\n";
+    out += CounterName(counter);
+    out += ' ';
+    out += std::to_string(GetCounter(counter));
+    out += '\n';
+  }
+  return out;
+}
+
+}  // namespace metrics
+
+}  // namespace frame
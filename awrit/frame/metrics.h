@@ -0,0 +1,133 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_METRICS_H
+#define AWRIT_FRAME_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace frame {
+
+// Latency histogram with HDR-style buckets: four per power of two, so any
+// value is within a quarter of the bucket it lands in. Values are whole
+// microseconds and bucket |i| holds values in (UpperBound(i - 1),
+// UpperBound(i)]. Recording is lock-free and safe from any thread.
+class Histogram {
+ public:
+  static constexpr size_t kBuckets = 4 + 4 * 34;
+
+  void Record(int64_t value);
+  // Number of recorded values no larger than |value|, exact when |value| is a
+  // bucket's upper bound, such as any power of two
+  uint64_t CountAtMost(int64_t value) const;
+  // Upper bound of the bucket holding the |quantile| of the recorded values,
+  // 0 when there are none
+  uint64_t Percentile(double quantile) const;
+  uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+
+  static size_t BucketFor(int64_t value);
+  static uint64_t UpperBound(size_t bucket);
+
+ private:
+  std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+  std::atomic<uint64_t> count_{0};
+  std::atomic<uint64_t> sum_{0};
+};
+
+namespace metrics {
+
+// Stages of the frame pipeline that are timed
+enum class Stage {
+  // the whole frame on the painter thread
+  paint,
+  // BGRA to RGB or RGBA
+  convert,
+  // acquiring a shared memory segment
+  shm,
+  // acquiring a frame file
+  file,
+  // compressing a direct frame
+  compress,
+  // building the graphics commands and queueing them for the tty
+  enqueue,
+  // a single writev to the tty
+  tty_write,
+  // a frame waiting to be painted after it was rendered
+  frame_wait,
+  count,
+};
+
+enum class Counter {
+  frames_painted,
+  // frames replaced before they could be painted
+  frames_dropped,
+  // pixel bytes handed to the terminal
+  pixel_bytes,
+  // bytes written to the tty
+  tty_bytes,
+  count,
+};
+
+namespace internal {
+extern std::atomic<bool> enabled;
+void Record(Stage stage, int64_t us);
+void Add(Counter counter, uint64_t value);
+}  // namespace internal
+
+// Nothing is recorded until metrics are enabled, which leaves a relaxed load
+// and a branch at each instrumented point
+void Enable(bool enable);
+inline bool Enabled() {
+  return internal::enabled.load(std::memory_order_relaxed);
+}
+
+inline void Record(Stage stage, int64_t us) {
+  if (Enabled()) internal::Record(stage, us);
+}
+
+inline void Add(Counter counter, uint64_t value) {
+  if (Enabled()) internal::Add(counter, value);
+}
+
+// Records the time from its construction to its destruction to |stage|
+class Timer {
+ public:
+  explicit Timer(Stage stage) : stage_(stage) {
+    if (Enabled()) start_ = std::chrono::steady_clock::now();
+  }
+  ~Timer() {
+    if (!Enabled() || start_ == std::chrono::steady_clock::time_point{})
+      return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start_);
+    internal::Record(stage_, elapsed.count());
+  }
+
+  Timer(const Timer&) = delete;
+  Timer& operator=(const Timer&) = delete;
+
+ private:
+  Stage stage_;
+  std::chrono::steady_clock::time_point start_{};
+};
+
+const char* StageName(Stage stage);
+const char* CounterName(Counter counter);
+const Histogram& GetHistogram(Stage stage);
+uint64_t GetCounter(Counter counter);
+
+// All metrics in the Prometheus text exposition format
+std::string FormatPrometheus();
+
+}  // namespace metrics
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_METRICS_H
@@ -0,0 +1,154 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "metrics_exporter.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include "metrics.h"
+
+namespace frame {
+
+namespace {
+constexpr char kSocketPrefix[] = "unix:";
+constexpr int kFileIntervalMs = 1000;
+constexpr int kDrainTimeoutMs = 100;
+
+bool WriteAll(int fd, const std::string& data) {
+  size_t written = 0;
+  while (written < data.size()) {
+    ssize_t result = write(fd, data.data() + written, data.size() - written);
+    if (result < 0 && errno == EINTR) continue;
+    if (result <= 0) return false;
+    written += result;
+  }
+  return true;
+}
+
+int Listen(const std::string& path) {
+  sockaddr_un address{};
+  if (path.size() >= sizeof(address.sun_path)) {
+    fprintf(stderr, "Metrics socket path is too long: %s\r\n", path.c_str());
+    return -1;
+  }
+  address.sun_family = AF_UNIX;
+  memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+  if (fd < 0) return -1;
+  // a socket left behind by an earlier run would fail the bind
+  unlink(path.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+      listen(fd, 4) < 0) {
+    fprintf(stderr, "Failed to listen on %s: %s\r\n", path.c_str(),
+            strerror(errno));
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+}  // namespace
+
+MetricsExporter::~MetricsExporter() { Stop(); }
+
+bool MetricsExporter::Start(const std::string& target) {
+  if (thread_.joinable()) return false;
+  if (target.rfind(kSocketPrefix, 0) == 0) {
+    path_ = target.substr(sizeof(kSocketPrefix) - 1);
+    listen_fd_ = Listen(path_);
+    if (listen_fd_ < 0) return false;
+  } else {
+    path_ = target;
+  }
+  if (pipe2(wake_fds_, O_CLOEXEC) < 0) {
+    if (listen_fd_ >= 0) close(listen_fd_);
+    listen_fd_ = -1;
+    return false;
+  }
+
+  metrics::Enable(true);
+  thread_ = std::thread(&MetricsExporter::Run, this);
+  return true;
+}
+
+void MetricsExporter::Stop() {
+  if (!thread_.joinable()) return;
+  char byte = 0;
+  while (write(wake_fds_[1], &byte, 1) < 0 && errno == EINTR) {
+  }
+  thread_.join();
+  metrics::Enable(false);
+  close(wake_fds_[0]);
+  close(wake_fds_[1]);
+  wake_fds_[0] = wake_fds_[1] = -1;
+
+  if (listen_fd_ >= 0) {
+    close(listen_fd_);
+    unlink(path_.c_str());
+    listen_fd_ = -1;
+  } else {
+    WriteFile();
+  }
+}
+
+void MetricsExporter::Run() {
+  pollfd fds[2] = {{wake_fds_[0], POLLIN, 0}, {listen_fd_, POLLIN, 0}};
+  const bool socket = listen_fd_ >= 0;
+  while (true) {
+    int ready = poll(fds, socket ? 2 : 1, socket ? -1 : kFileIntervalMs);
+    if (ready < 0 && errno != EINTR) return;
+    if (fds[0].revents) return;
+    if (!socket) {
+      if (ready == 0) WriteFile();
+      continue;
+    }
+    if (fds[1].revents & POLLIN) Serve();
+  }
+}
+
+void MetricsExporter::Serve() {
+  int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+  if (fd < 0) return;
+  // plain HTTP, so that Prometheus can scrape it through a socket proxy too
+  std::string body = metrics::FormatPrometheus();
+  std::string response =
+      "HTTP/1.0 200 OK\r\n"
+      "Content-Type: text/plain; version=0.0.4\r\n"
+      "Content-Length: " +
+      std::to_string(body.size()) + "\r\n\r\n" + body;
+  WriteAll(fd, response);
+  // closing with an unread request would reset the connection before the
+  // client reads the response
+  shutdown(fd, SHUT_WR);
+  pollfd request{fd, POLLIN, 0};
+  char buffer[1024];
+  while (poll(&request, 1, kDrainTimeoutMs) > 0 &&
+         read(fd, buffer, sizeof(buffer)) > 0) {
+  }
+  close(fd);
+}
+
+// Replaces the file through a rename, so readers never see it half written
+bool MetricsExporter::WriteFile() const {
+  std::string temp = path_ + ".tmp";
+  int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) return false;
+  bool written = WriteAll(fd, metrics::FormatPrometheus());
+  close(fd);
+  if (!written || rename(temp.c_str(), path_.c_str()) < 0) {
+    unlink(temp.c_str());
+    return false;
+  }
+  return true;
+}
+
+}  // namespace frame
@@ -0,0 +1,44 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_METRICS_EXPORTER_H
+#define AWRIT_FRAME_METRICS_EXPORTER_H
+
+#include <string>
+#include <thread>
+
+namespace frame {
+
+// Exports metrics::FormatPrometheus from a thread of its own. A target of
+// unix:<path> listens on a Unix socket and answers every connection with the
+// current metrics, which is what `curl --unix-socket` or socat expect. Any
+// other target is a file that is replaced once a second and on Stop, like the
+// textfile collector of node_exporter reads.
+class MetricsExporter {
+ public:
+  MetricsExporter() = default;
+  ~MetricsExporter();
+
+  MetricsExporter(const MetricsExporter&) = delete;
+  MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+  // Enables metrics and starts exporting them to |target|
+  bool Start(const std::string& target);
+  void Stop();
+
+ private:
+  std::string path_;
+  int listen_fd_ = -1;
+  // written to wake the thread when stopping
+  int wake_fds_[2] = {-1, -1};
+  std::thread thread_;
+
+  void Run();
+  void Serve();
+  bool WriteFile() const;
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_METRICS_EXPORTER_H
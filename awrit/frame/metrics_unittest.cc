@@ -0,0 +1,143 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "metrics.h"
+
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "metrics_exporter.h"
+
+using namespace frame;
+
+TEST(HistogramTest, BucketBounds) {
+  EXPECT_EQ(Histogram::BucketFor(0), 0u);
+  EXPECT_EQ(Histogram::BucketFor(1), 0u);
+  EXPECT_EQ(Histogram::BucketFor(4), 3u);
+  EXPECT_EQ(Histogram::BucketFor(5), 4u);
+  for (size_t i = 0; i + 1 < Histogram::kBuckets; ++i) {
+    auto upper = Histogram::UpperBound(i);
+    EXPECT_EQ(Histogram::BucketFor(upper), i);
+    EXPECT_EQ(Histogram::BucketFor(upper + 1), i + 1);
+  }
+}
+
+TEST(HistogramTest, QuarterPrecision) {
+  for (int64_t value = 1; value < (int64_t(1) << 30);
+       value = value * 3 / 2 + 1) {
+    size_t bucket = Histogram::BucketFor(value);
+    uint64_t upper = Histogram::UpperBound(bucket);
+    ASSERT_GE(upper, uint64_t(value));
+    EXPECT_LE(upper - value, std::max<uint64_t>(1, value / 4));
+  }
+}
+
+TEST(HistogramTest, CountsAtPowersOfTwo) {
+  Histogram histogram;
+  for (int64_t value : {1, 2, 3, 16, 17, 1000, 1024, 1025}) {
+    histogram.Record(value);
+  }
+  EXPECT_EQ(histogram.count(), 8u);
+  EXPECT_EQ(histogram.sum(), 1u + 2 + 3 + 16 + 17 + 1000 + 1024 + 1025);
+  EXPECT_EQ(histogram.CountAtMost(2), 2u);
+  EXPECT_EQ(histogram.CountAtMost(16), 4u);
+  EXPECT_EQ(histogram.CountAtMost(1024), 7u);
+  EXPECT_EQ(histogram.CountAtMost(2048), 8u);
+}
+
+TEST(HistogramTest, Percentiles) {
+  Histogram histogram;
+  EXPECT_EQ(histogram.Percentile(0.5), 0u);
+  for (int64_t value = 1; value <= 100; ++value) histogram.Record(value);
+  // within a quarter above the exact values of 50 and 99
+  EXPECT_EQ(histogram.Percentile(0.5), 56u);
+  EXPECT_EQ(histogram.Percentile(0.99), 112u);
+  EXPECT_EQ(histogram.Percentile(0), 1u);
+}
+
+TEST(MetricsTest, DisabledRecordsNothing) {
+  metrics::Enable(false);
+  auto before = metrics::GetHistogram(metrics::Stage::convert).count();
+  metrics::Record(metrics::Stage::convert, 10);
+  { metrics::Timer timer(metrics::Stage::convert); }
+  EXPECT_EQ(metrics::GetHistogram(metrics::Stage::convert).count(), before);
+}
+
+TEST(MetricsTest, PrometheusText) {
+  metrics::Enable(true);
+  auto bytes = metrics::GetCounter(metrics::Counter::pixel_bytes);
+  metrics::Add(metrics::Counter::pixel_bytes, 100);
+  metrics::Record(metrics::Stage::compress, 20);
+  metrics::Enable(false);
+
+  auto text = metrics::FormatPrometheus();
+  EXPECT_NE(text.find("# TYPE awrit_stage_duration_seconds histogram\n"),
+            std::string::npos);
+  auto count = metrics::GetHistogram(metrics::Stage::compress).count();
+  EXPECT_NE(text.find("awrit_stage_duration_seconds_bucket{stage=\"compress\","
+                      "le=\"+Inf\"} " +
+                      std::to_string(count) + "\n"),
+            std::string::npos);
+  EXPECT_NE(text.find("awrit_stage_duration_seconds_bucket{stage=\"compress\","
+                      "le=\"3.2e-05\"} "),
+            std::string::npos);
+  EXPECT_NE(text.find("awrit_pixel_bytes_total " + std::to_string(bytes + 100) +
+                      "\n"),
+            std::string::npos);
+}
+
+TEST(MetricsExporterTest, WritesFile) {
+  char path[] = "/tmp/awrit-metrics-XXXXXX";
+  int fd = mkstemp(path);
+  ASSERT_GE(fd, 0);
+  close(fd);
+  {
+    MetricsExporter exporter;
+    ASSERT_TRUE(exporter.Start(path));
+    EXPECT_TRUE(metrics::Enabled());
+  }
+  EXPECT_FALSE(metrics::Enabled());
+
+  FILE* file = fopen(path, "r");
+  ASSERT_NE(file, nullptr);
+  char line[256] = {};
+  ASSERT_NE(fgets(line, sizeof(line), file), nullptr);
+  EXPECT_EQ(strncmp(line, "# HELP awrit_stage_duration_seconds", 35), 0);
+  fclose(file);
+  unlink(path);
+}
+
+TEST(MetricsExporterTest, AnswersOnSocket) {
+  std::string path = "/tmp/awrit-metrics-" + std::to_string(getpid()) + ".sock";
+  MetricsExporter exporter;
+  ASSERT_TRUE(exporter.Start("unix:" + path));
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  strcpy(address.sun_path, path.c_str());
+  ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)),
+            0);
+  const char request[] = "GET / HTTP/1.0\r\n\r\n";
+  ASSERT_GT(write(fd, request, sizeof(request) - 1), 0);
+
+  std::string response;
+  char buffer[4096];
+  ssize_t got;
+  while ((got = read(fd, buffer, sizeof(buffer))) > 0) {
+    response.append(buffer, got);
+  }
+  close(fd);
+
+  EXPECT_EQ(response.rfind("HTTP/1.0 200 OK\r\n", 0), 0u);
+  EXPECT_NE(response.find("awrit_tty_bytes_total"), std::string::npos);
+  exporter.Stop();
+  EXPECT_NE(access(path.c_str(), F_OK), 0);
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "pacer.h"
+
+namespace frame {
+
+FramePacer::FramePacer(size_t max_unacked, Clock::duration timeout)
+    : max_unacked_(max_unacked ? max_unacked : 1), timeout_(timeout) {}
+
+void FramePacer::Sent(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  unacked_.push_back(now);
+  ++sent_;
+}
+
+void FramePacer::Acknowledged(bool ok) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  // late answers to frames that timed out find nothing to pop
+  if (!unacked_.empty()) unacked_.pop_front();
+  timeouts_in_a_row_ = 0;
+  ++acknowledged_;
+  if (!ok) error_ = true;
+}
+
+bool FramePacer::Ready(Clock::time_point now) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  while (!unacked_.empty() && now - unacked_.front() >= timeout_) {
+    unacked_.pop_front();
+    ++timeouts_;
+    ++timeouts_in_a_row_;
+  }
+  if (timeouts_in_a_row_ >= kMaxTimeoutsInARow) return true;
+  return unacked_.size() < max_unacked_;
+}
+
+bool FramePacer::TakeError() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  bool error = error_;
+  error_ = false;
+  return error;
+}
+
+bool FramePacer::pacing() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timeouts_in_a_row_ < kMaxTimeoutsInARow;
+}
+
+uint64_t FramePacer::sent() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return sent_;
+}
+
+uint64_t FramePacer::acknowledged() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return acknowledged_;
+}
+
+uint64_t FramePacer::timeouts() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return timeouts_;
+}
+
+}  // namespace frame
@@ -0,0 +1,61 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_PACER_H
+#define AWRIT_FRAME_PACER_H
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace frame {
+
+// Keeps rendering in step with the terminal. Every painted frame asks the
+// terminal for an acknowledgement and no new frame is rendered while
+// |max_unacked| are still waiting for theirs.
+//
+// An acknowledgement that takes longer than |timeout| is given up on. After a
+// few of those in a row the terminal is assumed to not answer at all and
+// pacing is off until an acknowledgement arrives after all.
+class FramePacer {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit FramePacer(size_t max_unacked = 1,
+                      Clock::duration timeout = std::chrono::milliseconds(250));
+
+  // A frame asking for an acknowledgement was sent
+  void Sent(Clock::time_point now = Clock::now());
+  // The terminal answered the oldest frame, |ok| is false for an error
+  void Acknowledged(bool ok);
+  // Whether the next frame may be rendered
+  bool Ready(Clock::time_point now = Clock::now());
+  // Whether the terminal reported an error since the last call
+  bool TakeError();
+  // Whether acknowledgements are still waited for, false once Ready found the
+  // terminal to not answer at all
+  bool pacing();
+
+  uint64_t sent();
+  uint64_t acknowledged();
+  uint64_t timeouts();
+
+ private:
+  static constexpr int kMaxTimeoutsInARow = 3;
+
+  const size_t max_unacked_;
+  const Clock::duration timeout_;
+  std::mutex mutex_;
+  std::deque<Clock::time_point> unacked_;
+  int timeouts_in_a_row_ = 0;
+  bool error_ = false;
+  uint64_t sent_ = 0;
+  uint64_t acknowledged_ = 0;
+  uint64_t timeouts_ = 0;
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_PACER_H
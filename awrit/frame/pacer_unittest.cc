@@ -0,0 +1,75 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "pacer.h"
+
+#include <gtest/gtest.h>
+
+using namespace frame;
+using std::chrono::milliseconds;
+
+TEST(FramePacerTest, WaitsForAcknowledgement) {
+  FramePacer pacer(1, milliseconds(250));
+  const auto start = FramePacer::Clock::now();
+  EXPECT_TRUE(pacer.Ready(start));
+
+  pacer.Sent(start);
+  EXPECT_FALSE(pacer.Ready(start + milliseconds(10)));
+
+  pacer.Acknowledged(true);
+  EXPECT_TRUE(pacer.Ready(start + milliseconds(20)));
+  EXPECT_EQ(pacer.sent(), 1u);
+  EXPECT_EQ(pacer.acknowledged(), 1u);
+  EXPECT_FALSE(pacer.TakeError());
+}
+
+TEST(FramePacerTest, AllowsSeveralInFlight) {
+  FramePacer pacer(2, milliseconds(250));
+  const auto start = FramePacer::Clock::now();
+  pacer.Sent(start);
+  EXPECT_TRUE(pacer.Ready(start));
+  pacer.Sent(start);
+  EXPECT_FALSE(pacer.Ready(start));
+  pacer.Acknowledged(true);
+  EXPECT_TRUE(pacer.Ready(start));
+}
+
+TEST(FramePacerTest, GivesUpAfterTimeout) {
+  FramePacer pacer(1, milliseconds(100));
+  const auto start = FramePacer::Clock::now();
+  pacer.Sent(start);
+  EXPECT_FALSE(pacer.Ready(start + milliseconds(99)));
+  EXPECT_TRUE(pacer.Ready(start + milliseconds(100)));
+  EXPECT_EQ(pacer.timeouts(), 1u);
+}
+
+TEST(FramePacerTest, StopsPacingSilentTerminals) {
+  FramePacer pacer(1, milliseconds(100));
+  auto now = FramePacer::Clock::now();
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(pacer.pacing());
+    pacer.Sent(now);
+    now += milliseconds(100);
+    EXPECT_TRUE(pacer.Ready(now));
+  }
+
+  // no longer waits for a terminal that never answers
+  EXPECT_FALSE(pacer.pacing());
+  pacer.Sent(now);
+  EXPECT_TRUE(pacer.Ready(now));
+
+  // until it does
+  pacer.Acknowledged(true);
+  EXPECT_TRUE(pacer.pacing());
+  pacer.Sent(now);
+  EXPECT_FALSE(pacer.Ready(now));
+}
+
+TEST(FramePacerTest, ReportsErrors) {
+  FramePacer pacer;
+  pacer.Sent();
+  pacer.Acknowledged(false);
+  EXPECT_TRUE(pacer.TakeError());
+  EXPECT_FALSE(pacer.TakeError());
+}
@@ -0,0 +1,272 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "pixels.h"
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AWRIT_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace frame {
+
+namespace {
+
+// Kernels return whether every pixel was opaque, which they track by ANDing
+// all pixels together and checking the alpha byte of the result
+using RowKernel = bool (*)(const uint8_t* src, uint8_t* dest, size_t pixels);
+
+constexpr uint32_t kAlphaMask = 0xff000000u;
+
+// swaps the B and R channels of a little-endian BGRA pixel
+inline uint32_t SwapRB(uint32_t px) {
+  return (px & 0xff00ff00u) | ((px >> 16) & 0xffu) | ((px & 0xffu) << 16);
+}
+
+bool SwizzleScalar(const uint8_t* src, uint8_t* dest, size_t pixels) {
+  uint32_t all = 0xffffffffu;
+  for (size_t i = 0; i < pixels; ++i) {
+    uint32_t px;
+    memcpy(&px, src + i * 4, 4);
+    all &= px;
+    px = SwapRB(px);
+    memcpy(dest + i * 4, &px, 4);
+  }
+  return (all & kAlphaMask) == kAlphaMask;
+}
+
+bool PackRGBScalar(const uint8_t* src, uint8_t* dest, size_t pixels) {
+  uint8_t alpha = 0xff;
+  for (size_t i = 0; i < pixels; ++i, src += 4, dest += 3) {
+    dest[0] = src[2];
+    dest[1] = src[1];
+    dest[2] = src[0];
+    alpha &= src[3];
+  }
+  return alpha == 0xff;
+}
+
+#if defined(AWRIT_X86_DISPATCH)
+__attribute__((target("sse2"))) bool AllOpaque(__m128i all) {
+  const __m128i alpha = _mm_set1_epi32(static_cast<int>(kAlphaMask));
+  __m128i masked = _mm_and_si128(all, alpha);
+  return _mm_movemask_epi8(_mm_cmpeq_epi32(masked, alpha)) == 0xffff;
+}
+
+__attribute__((target("sse2"))) bool SwizzleSSE2(const uint8_t* src,
+                                                 uint8_t* dest,
+                                                 size_t pixels) {
+  const __m128i ga_mask = _mm_set1_epi32(static_cast<int>(0xff00ff00u));
+  const __m128i rb_mask = _mm_set1_epi32(0x00ff00ff);
+  __m128i all = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 4 <= pixels; i += 4) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    all = _mm_and_si128(all, px);
+    __m128i ga = _mm_and_si128(px, ga_mask);
+    __m128i rb = _mm_and_si128(px, rb_mask);
+    // rotating each 32-bit lane by 16 bits swaps the B and R bytes
+    rb = _mm_or_si128(_mm_slli_epi32(rb, 16), _mm_srli_epi32(rb, 16));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4),
+                     _mm_or_si128(ga, rb));
+  }
+  bool tail = SwizzleScalar(src + i * 4, dest + i * 4, pixels - i);
+  return AllOpaque(all) && tail;
+}
+
+__attribute__((target("ssse3"))) bool SwizzleSSSE3(const uint8_t* src,
+                                                   uint8_t* dest,
+                                                   size_t pixels) {
+  const __m128i shuffle =
+      _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  __m128i all = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 4 <= pixels; i += 4) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    all = _mm_and_si128(all, px);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4),
+                     _mm_shuffle_epi8(px, shuffle));
+  }
+  bool tail = SwizzleScalar(src + i * 4, dest + i * 4, pixels - i);
+  return AllOpaque(all) && tail;
+}
+
+__attribute__((target("ssse3"))) bool PackRGBSSSE3(const uint8_t* src,
+                                                   uint8_t* dest,
+                                                   size_t pixels) {
+  // 4 pixels become 12 bytes, the 4 bytes past them are overwritten by the
+  // next store so the loop stops while there is room for a full 16
+  const __m128i shuffle =
+      _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  __m128i all = _mm_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 6 <= pixels; i += 4) {
+    __m128i px = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+    all = _mm_and_si128(all, px);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 3),
+                     _mm_shuffle_epi8(px, shuffle));
+  }
+  bool tail = PackRGBScalar(src + i * 4, dest + i * 3, pixels - i);
+  return AllOpaque(all) && tail;
+}
+
+__attribute__((target("avx2"))) bool AllOpaque256(__m256i all) {
+  const __m256i alpha = _mm256_set1_epi32(static_cast<int>(kAlphaMask));
+  __m256i masked = _mm256_and_si256(all, alpha);
+  return _mm256_movemask_epi8(_mm256_cmpeq_epi32(masked, alpha)) == -1;
+}
+
+__attribute__((target("avx2"))) bool SwizzleAVX2(const uint8_t* src,
+                                                 uint8_t* dest,
+                                                 size_t pixels) {
+  const __m256i shuffle =
+      _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+                       2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+  __m256i all = _mm256_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 16 <= pixels; i += 16) {
+    __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    __m256i b =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4 + 32));
+    all = _mm256_and_si256(all, _mm256_and_si256(a, b));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4),
+                        _mm256_shuffle_epi8(a, shuffle));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4 + 32),
+                        _mm256_shuffle_epi8(b, shuffle));
+  }
+  for (; i + 8 <= pixels; i += 8) {
+    __m256i a =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    all = _mm256_and_si256(all, a);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4),
+                        _mm256_shuffle_epi8(a, shuffle));
+  }
+  bool tail = SwizzleScalar(src + i * 4, dest + i * 4, pixels - i);
+  return AllOpaque256(all) && tail;
+}
+
+__attribute__((target("avx2"))) bool PackRGBAVX2(const uint8_t* src,
+                                                 uint8_t* dest,
+                                                 size_t pixels) {
+  // each 128-bit lane packs 4 pixels into its low 12 bytes, the permute then
+  // joins both lanes into 24 contiguous bytes; like the SSSE3 kernel the
+  // store spills 8 bytes that the next iteration overwrites
+  const __m256i shuffle = _mm256_setr_epi8(
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1,  //
+      2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+  const __m256i permute = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+  __m256i all = _mm256_set1_epi32(-1);
+  size_t i = 0;
+  for (; i + 11 <= pixels; i += 8) {
+    __m256i px =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+    all = _mm256_and_si256(all, px);
+    __m256i packed = _mm256_permutevar8x32_epi32(
+        _mm256_shuffle_epi8(px, shuffle), permute);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 3), packed);
+  }
+  bool tail = PackRGBScalar(src + i * 4, dest + i * 3, pixels - i);
+  return AllOpaque256(all) && tail;
+}
+#endif
+
+RowKernel GetSwizzleKernel(Kernel kernel) {
+  switch (kernel) {
+#if defined(AWRIT_X86_DISPATCH)
+    case Kernel::SSE2:
+      return SwizzleSSE2;
+    case Kernel::SSSE3:
+      return SwizzleSSSE3;
+    case Kernel::AVX2:
+      return SwizzleAVX2;
+#endif
+    default:
+      return SwizzleScalar;
+  }
+}
+
+RowKernel GetPackRGBKernel(Kernel kernel) {
+  switch (kernel) {
+#if defined(AWRIT_X86_DISPATCH)
+    case Kernel::SSSE3:
+      return PackRGBSSSE3;
+    case Kernel::AVX2:
+      return PackRGBAVX2;
+#endif
+    default:
+      return PackRGBScalar;
+  }
+}
+
+RowKernel BestSwizzleKernel() {
+  static const RowKernel kernel = GetSwizzleKernel(BestKernel());
+  return kernel;
+}
+
+RowKernel BestPackRGBKernel() {
+  static const RowKernel kernel = GetPackRGBKernel(BestKernel());
+  return kernel;
+}
+
+}  // namespace
+
+bool SwizzleRow(const void* src, void* dest, size_t pixels, Kernel kernel) {
+  return GetSwizzleKernel(kernel)(static_cast<const uint8_t*>(src),
+                                  static_cast<uint8_t*>(dest), pixels);
+}
+
+bool PackRowRGB(const void* src, void* dest, size_t pixels, Kernel kernel) {
+  return GetPackRGBKernel(kernel)(static_cast<const uint8_t*>(src),
+                                  static_cast<uint8_t*>(dest), pixels);
+}
+
+bool CopyRectAsRGBA(const void* src, size_t stride, const Rect& rect,
+                    void* dest) {
+  if (rect.IsEmpty()) return true;
+  const RowKernel kernel = BestSwizzleKernel();
+  const size_t row_bytes = static_cast<size_t>(rect.width) * 4;
+  const auto* in =
+      static_cast<const uint8_t*>(src) + rect.y * stride + rect.x * 4;
+  auto* out = static_cast<uint8_t*>(dest);
+
+  // whole rows are contiguous, convert them in one go
+  if (row_bytes == stride) {
+    return kernel(in, out, static_cast<size_t>(rect.width) * rect.height);
+  }
+
+  bool opaque = true;
+  for (int row = 0; row < rect.height; ++row) {
+    opaque &= kernel(in, out, rect.width);
+    in += stride;
+    out += row_bytes;
+  }
+  return opaque;
+}
+
+bool CopyRectAsRGB(const void* src, size_t stride, const Rect& rect,
+                   void* dest) {
+  if (rect.IsEmpty()) return true;
+  const RowKernel kernel = BestPackRGBKernel();
+  const auto* in =
+      static_cast<const uint8_t*>(src) + rect.y * stride + rect.x * 4;
+  auto* out = static_cast<uint8_t*>(dest);
+  const size_t row_bytes = static_cast<size_t>(rect.width) * 3;
+
+  if (static_cast<size_t>(rect.width) * 4 == stride) {
+    return kernel(in, out, static_cast<size_t>(rect.width) * rect.height);
+  }
+
+  for (int row = 0; row < rect.height; ++row) {
+    if (!kernel(in, out, rect.width)) return false;
+    in += stride;
+    out += row_bytes;
+  }
+  return true;
+}
+
+}  // namespace frame
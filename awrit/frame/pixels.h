@@ -0,0 +1,47 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_PIXELS_H
+#define AWRIT_FRAME_PIXELS_H
+
+#include <cstddef>
+
+#include "rect.h"
+#include "simd/kernel.h"
+
+namespace frame {
+
+// The pixel conversions have a kernel for each instruction set
+using simd::BestKernel;
+using simd::IsSupported;
+using simd::Kernel;
+using simd::KernelName;
+
+// Output formats, the value is the number of bits per pixel
+enum class PixelFormat : int { RGB = 24, RGBA = 32 };
+
+inline size_t BytesPerPixel(PixelFormat format) {
+  return static_cast<size_t>(format) / 8;
+}
+
+// Converts |pixels| BGRA pixels at |src| into RGBA at |dest|, returns whether
+// every pixel was opaque
+bool SwizzleRow(const void* src, void* dest, size_t pixels, Kernel kernel);
+// Converts |pixels| BGRA pixels at |src| into RGB at |dest|, dropping alpha,
+// returns whether every pixel was opaque
+bool PackRowRGB(const void* src, void* dest, size_t pixels, Kernel kernel);
+
+// Converts |rect| of the BGRA image at |src|, whose rows are |stride| bytes
+// apart, into tightly packed RGBA at |dest| using the best kernel. Returns
+// whether every pixel was opaque.
+bool CopyRectAsRGBA(const void* src, size_t stride, const Rect& rect,
+                    void* dest);
+// Same as CopyRectAsRGBA but packs RGB, stops and returns false as soon as a
+// row with a translucent pixel is found
+bool CopyRectAsRGB(const void* src, size_t stride, const Rect& rect,
+                   void* dest);
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_PIXELS_H
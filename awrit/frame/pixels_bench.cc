@@ -0,0 +1,52 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+// Measures the throughput of each pixel conversion kernel:
+//   pixels_bench [width] [height] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "pixels.h"
+
+int main(int argc, char* argv[]) {
+  const int width = argc > 1 ? atoi(argv[1]) : 3840;
+  const int height = argc > 2 ? atoi(argv[2]) : 2160;
+  const int iterations = argc > 3 ? atoi(argv[3]) : 100;
+  const size_t pixels = static_cast<size_t>(width) * height;
+
+  std::vector<uint8_t> src(pixels * 4), dest(pixels * 4);
+  for (size_t i = 0; i < src.size(); ++i) src[i] = i * 31;
+
+  printf("%dx%d, %d iterations\n", width, height, iterations);
+  using Row = bool (*)(const void*, void*, size_t, frame::Kernel);
+  const struct {
+    const char* name;
+    Row row;
+  } conversions[] = {{"rgba", frame::SwizzleRow}, {"rgb", frame::PackRowRGB}};
+
+  for (const auto& conversion : conversions) {
+    for (auto kernel : {frame::Kernel::Scalar, frame::Kernel::SSE2,
+                        frame::Kernel::SSSE3, frame::Kernel::AVX2}) {
+      if (!frame::IsSupported(kernel)) continue;
+
+      conversion.row(src.data(), dest.data(), pixels, kernel);
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < iterations; ++i) {
+        conversion.row(src.data(), dest.data(), pixels, kernel);
+      }
+      std::chrono::duration<double> elapsed =
+          std::chrono::steady_clock::now() - start;
+
+      double per_frame_ms = elapsed.count() * 1000 / iterations;
+      double gib_per_s = src.size() * static_cast<double>(iterations) /
+                         elapsed.count() / (1 << 30);
+      printf("%-5s %-8s %8.3f ms/frame %8.2f GiB/s read\n", conversion.name,
+             frame::KernelName(kernel), per_frame_ms, gib_per_s);
+    }
+  }
+  return 0;
+}
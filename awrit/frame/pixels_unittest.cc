@@ -0,0 +1,120 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "pixels.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+using namespace frame;
+
+namespace {
+std::vector<uint8_t> RandomPixels(size_t pixels) {
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::vector<uint8_t> result(pixels * 4);
+  for (auto& byte : result) byte = dist(engine);
+  return result;
+}
+}  // namespace
+
+TEST(PixelsTest, ScalarSwapsRedAndBlue) {
+  const uint8_t bgra[] = {1, 2, 3, 4, 5, 6, 7, 8};
+  uint8_t rgba[8] = {};
+  SwizzleRow(bgra, rgba, 2, Kernel::Scalar);
+  const uint8_t expected[] = {3, 2, 1, 4, 7, 6, 5, 8};
+  EXPECT_EQ(0, memcmp(rgba, expected, sizeof(expected)));
+}
+
+TEST(PixelsTest, ScalarPacksRGB) {
+  const uint8_t bgra[] = {1, 2, 3, 255, 5, 6, 7, 255};
+  uint8_t rgb[6] = {};
+  EXPECT_TRUE(PackRowRGB(bgra, rgb, 2, Kernel::Scalar));
+  const uint8_t expected[] = {3, 2, 1, 7, 6, 5};
+  EXPECT_EQ(0, memcmp(rgb, expected, sizeof(expected)));
+}
+
+TEST(PixelsTest, KernelsMatchScalar) {
+  for (Kernel kernel : {Kernel::SSE2, Kernel::SSSE3, Kernel::AVX2}) {
+    if (!IsSupported(kernel)) continue;
+    // odd sizes exercise the tails of every kernel
+    for (size_t pixels : {0, 1, 3, 4, 7, 8, 11, 15, 16, 17, 33, 1023}) {
+      auto src = RandomPixels(pixels);
+      std::vector<uint8_t> expected(src.size()), actual(src.size());
+      EXPECT_EQ(
+          SwizzleRow(src.data(), expected.data(), pixels, Kernel::Scalar),
+          SwizzleRow(src.data(), actual.data(), pixels, kernel));
+      EXPECT_EQ(expected, actual)
+          << KernelName(kernel) << " with " << pixels << " pixels";
+
+      std::vector<uint8_t> expected_rgb(pixels * 3), actual_rgb(pixels * 3);
+      EXPECT_EQ(
+          PackRowRGB(src.data(), expected_rgb.data(), pixels, Kernel::Scalar),
+          PackRowRGB(src.data(), actual_rgb.data(), pixels, kernel));
+      EXPECT_EQ(expected_rgb, actual_rgb)
+          << KernelName(kernel) << " RGB with " << pixels << " pixels";
+    }
+  }
+}
+
+TEST(PixelsTest, KernelsDetectTranslucency) {
+  for (Kernel kernel :
+       {Kernel::Scalar, Kernel::SSE2, Kernel::SSSE3, Kernel::AVX2}) {
+    if (!IsSupported(kernel)) continue;
+    for (size_t translucent : {0, 5, 30, 98}) {
+      std::vector<uint8_t> src(99 * 4, 0xff);
+      std::vector<uint8_t> dest(src.size());
+      EXPECT_TRUE(SwizzleRow(src.data(), dest.data(), 99, kernel));
+      EXPECT_TRUE(PackRowRGB(src.data(), dest.data(), 99, kernel));
+
+      src[translucent * 4 + 3] = 0xfe;
+      EXPECT_FALSE(SwizzleRow(src.data(), dest.data(), 99, kernel))
+          << KernelName(kernel) << " pixel " << translucent;
+      EXPECT_FALSE(PackRowRGB(src.data(), dest.data(), 99, kernel))
+          << KernelName(kernel) << " RGB pixel " << translucent;
+    }
+  }
+}
+
+TEST(PixelsTest, CopyRect) {
+  const int width = 37, height = 11;
+  auto src = RandomPixels(width * height);
+  const Rect rect{5, 3, 19, 6};
+
+  std::vector<uint8_t> actual(rect.Area() * 4);
+  CopyRectAsRGBA(src.data(), width * 4, rect, actual.data());
+
+  std::vector<uint8_t> expected(rect.Area() * 4);
+  for (int row = 0; row < rect.height; ++row) {
+    SwizzleRow(src.data() + ((rect.y + row) * width + rect.x) * 4,
+               expected.data() + row * rect.width * 4, rect.width,
+               Kernel::Scalar);
+  }
+  EXPECT_EQ(expected, actual);
+}
+
+TEST(PixelsTest, CopyRectAsRGBStopsAtTranslucency) {
+  const int width = 16, height = 4;
+  std::vector<uint8_t> src(width * height * 4, 0xff);
+  std::vector<uint8_t> dest(width * height * 3);
+  EXPECT_TRUE(CopyRectAsRGB(src.data(), width * 4, {2, 1, 8, 3}, dest.data()));
+
+  src[(3 * width + 4) * 4 + 3] = 0x80;
+  EXPECT_FALSE(
+      CopyRectAsRGB(src.data(), width * 4, {2, 1, 8, 3}, dest.data()));
+  EXPECT_TRUE(CopyRectAsRGB(src.data(), width * 4, {2, 1, 8, 2}, dest.data()));
+}
+
+TEST(PixelsTest, CopyFullFrame) {
+  const int width = 64, height = 9;
+  auto src = RandomPixels(width * height);
+  std::vector<uint8_t> actual(src.size()), expected(src.size());
+  CopyRectAsRGBA(src.data(), width * 4, {0, 0, width, height}, actual.data());
+  SwizzleRow(src.data(), expected.data(), width * height, Kernel::Scalar);
+  EXPECT_EQ(expected, actual);
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_RECT_H
+#define AWRIT_FRAME_RECT_H
+
+#include <algorithm>
+#include <cstdint>
+
+namespace frame {
+
+struct Size {
+  int width = 0;
+  int height = 0;
+
+  bool operator==(const Size& other) const {
+    return width == other.width && height == other.height;
+  }
+  bool operator!=(const Size& other) const { return !(*this == other); }
+};
+
+struct Rect {
+  int x = 0;
+  int y = 0;
+  int width = 0;
+  int height = 0;
+
+  bool IsEmpty() const { return width <= 0 || height <= 0; }
+  int64_t Area() const {
+    return IsEmpty() ? 0 : static_cast<int64_t>(width) * height;
+  }
+  int Right() const { return x + width; }
+  int Bottom() const { return y + height; }
+
+  // smallest rect containing both, empty rects are ignored
+  Rect Union(const Rect& other) const {
+    if (IsEmpty()) return other;
+    if (other.IsEmpty()) return *this;
+    int left = std::min(x, other.x);
+    int top = std::min(y, other.y);
+    return {left, top, std::max(Right(), other.Right()) - left,
+            std::max(Bottom(), other.Bottom()) - top};
+  }
+
+  Rect Intersect(const Rect& other) const {
+    int left = std::max(x, other.x);
+    int top = std::max(y, other.y);
+    int right = std::min(Right(), other.Right());
+    int bottom = std::min(Bottom(), other.Bottom());
+    if (right <= left || bottom <= top) return {};
+    return {left, top, right - left, bottom - top};
+  }
+
+  bool operator==(const Rect& other) const {
+    return x == other.x && y == other.y && width == other.width &&
+           height == other.height;
+  }
+  bool operator!=(const Rect& other) const { return !(*this == other); }
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_RECT_H
@@ -0,0 +1,23 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "recycler.h"
+
+namespace frame {
+
+void Recycler::Submit(PooledBuffer& buffer, bool acknowledge,
+                      Clock::time_point now) {
+  if (acknowledge) ++requested_;
+  buffer.in_flight = true;
+  buffer.released_at = acknowledge ? requested_ : requested_ + 1;
+  buffer.submitted = now;
+}
+
+bool Recycler::IsReusable(const PooledBuffer& buffer,
+                          Clock::time_point now) const {
+  return !buffer.in_flight || acknowledged_ >= buffer.released_at ||
+         now - buffer.submitted >= timeout_;
+}
+
+}  // namespace frame
@@ -0,0 +1,80 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_RECYCLER_H
+#define AWRIT_FRAME_RECYCLER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace frame {
+
+// What a pool keeps about each of its buffers for Recycler
+struct PooledBuffer {
+  size_t capacity = 0;
+  // handed to the terminal and maybe not read yet
+  bool in_flight = false;
+  // acknowledgements after which the terminal is done with it
+  uint64_t released_at = 0;
+  std::chrono::steady_clock::time_point submitted;
+};
+
+// Decides when the buffers of a pool that were handed to the terminal may be
+// written again. The terminal reads a buffer while it executes the command
+// naming it and executes commands in order, so a buffer is done with once the
+// terminal answered that command or any later one. Commands that don't ask
+// for an answer wait for the next one that does.
+//
+// An answer that takes longer than |timeout| is given up on, as FramePacer
+// gives up on a frame, so a buffer never waits for an answer that no command
+// is going to produce. Otherwise buffers are never taken back from the
+// terminal, a pool that has none free creates another or fails.
+class Recycler {
+ public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit Recycler(Clock::duration timeout = std::chrono::milliseconds(250))
+      : timeout_(timeout) {}
+
+  // |buffer| was handed over, |acknowledge| when its command asks for an answer
+  void Submit(PooledBuffer& buffer, bool acknowledge,
+              Clock::time_point now = Clock::now());
+  // The terminal answered |count| more commands that asked for it
+  void Acknowledged(uint64_t count = 1) { acknowledged_ += count; }
+  bool IsReusable(const PooledBuffer& buffer,
+                  Clock::time_point now = Clock::now()) const;
+  // Stops waiting for the answer to |buffer|, for when none is coming
+  void Release(PooledBuffer& buffer) const { buffer.released_at = 0; }
+
+  // The reusable buffer that fits |size| best, or else the largest reusable
+  // one to grow, nullptr when every buffer is in flight
+  template <typename Buffer>
+  Buffer* Pick(const std::vector<std::unique_ptr<Buffer>>& buffers,
+               size_t size, Clock::time_point now = Clock::now()) const {
+    Buffer* fit = nullptr;
+    Buffer* largest = nullptr;
+    for (const auto& buffer : buffers) {
+      if (!IsReusable(*buffer, now)) continue;
+      if (buffer->capacity >= size) {
+        if (!fit || buffer->capacity < fit->capacity) fit = buffer.get();
+      } else if (!largest || buffer->capacity > largest->capacity) {
+        largest = buffer.get();
+      }
+    }
+    return fit ? fit : largest;
+  }
+
+ private:
+  const Clock::duration timeout_;
+  // commands that asked for an answer, and the answers so far
+  uint64_t requested_ = 0;
+  uint64_t acknowledged_ = 0;
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_RECYCLER_H
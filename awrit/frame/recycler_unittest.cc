@@ -0,0 +1,71 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "recycler.h"
+
+#include <gtest/gtest.h>
+
+using namespace frame;
+
+TEST(RecyclerTest, ReleasesOnAcknowledgement) {
+  Recycler recycler;
+  PooledBuffer buffer;
+  EXPECT_TRUE(recycler.IsReusable(buffer));
+
+  recycler.Submit(buffer, true);
+  EXPECT_FALSE(recycler.IsReusable(buffer));
+  recycler.Acknowledged();
+  EXPECT_TRUE(recycler.IsReusable(buffer));
+}
+
+TEST(RecyclerTest, UnansweredWaitsForNextAcknowledgement) {
+  Recycler recycler;
+  PooledBuffer earlier, quiet, last;
+  recycler.Submit(earlier, true);
+  recycler.Submit(quiet, false);
+
+  // the answer is for the earlier command
+  recycler.Acknowledged();
+  EXPECT_TRUE(recycler.IsReusable(earlier));
+  EXPECT_FALSE(recycler.IsReusable(quiet));
+
+  recycler.Submit(last, true);
+  recycler.Acknowledged();
+  EXPECT_TRUE(recycler.IsReusable(quiet));
+  EXPECT_TRUE(recycler.IsReusable(last));
+}
+
+TEST(RecyclerTest, GivesUpOnAnswersAfterTimeout) {
+  Recycler recycler(std::chrono::milliseconds(250));
+  const auto start = Recycler::Clock::now();
+  PooledBuffer answered, unanswered;
+  recycler.Submit(answered, true, start);
+  // no command after it asks for an answer, like a popup between frames
+  recycler.Submit(unanswered, false, start);
+
+  EXPECT_FALSE(recycler.IsReusable(answered, start));
+  EXPECT_FALSE(recycler.IsReusable(unanswered, start));
+  const auto later = start + std::chrono::milliseconds(250);
+  EXPECT_TRUE(recycler.IsReusable(answered, later));
+  EXPECT_TRUE(recycler.IsReusable(unanswered, later));
+}
+
+TEST(RecyclerTest, PicksBestFitOrLargest) {
+  Recycler recycler;
+  std::vector<std::unique_ptr<PooledBuffer>> buffers;
+  for (size_t capacity : {1024, 4096, 8192}) {
+    buffers.push_back(std::make_unique<PooledBuffer>());
+    buffers.back()->capacity = capacity;
+  }
+
+  EXPECT_EQ(recycler.Pick(buffers, 2000), buffers[1].get());
+  EXPECT_EQ(recycler.Pick(buffers, 10000), buffers[2].get());
+
+  recycler.Submit(*buffers[1], true);
+  EXPECT_EQ(recycler.Pick(buffers, 2000), buffers[2].get());
+  recycler.Submit(*buffers[2], true);
+  EXPECT_EQ(recycler.Pick(buffers, 2000), buffers[0].get());
+  recycler.Submit(*buffers[0], true);
+  EXPECT_EQ(recycler.Pick(buffers, 2000), nullptr);
+}
@@ -0,0 +1,34 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "render_scale.h"
+
+#include <algorithm>
+
+namespace frame {
+
+RenderScaler::RenderScaler(float min_scale, std::chrono::microseconds budget)
+    : min_scale_(std::clamp(min_scale, kStep, 1.0f)),
+      budget_us_(budget.count()) {}
+
+bool RenderScaler::Painted(std::chrono::microseconds paint_time) {
+  const int64_t us = paint_time.count();
+  over_ = us > budget_us_ ? over_ + 1 : 0;
+  // stepping up costs about twice the time per frame, so leave room for it
+  under_ = us * 3 < budget_us_ ? under_ + 1 : 0;
+
+  float scale = scale_;
+  if (over_ >= kFramesToChange) {
+    scale = std::max(min_scale_, scale_ - kStep);
+  } else if (under_ >= kFramesToChange) {
+    scale = std::min(1.0f, scale_ + kStep);
+  }
+  if (scale == scale_) return false;
+
+  scale_ = scale;
+  over_ = under_ = 0;
+  return true;
+}
+
+}  // namespace frame
@@ -0,0 +1,41 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_RENDER_SCALE_H
+#define AWRIT_FRAME_RENDER_SCALE_H
+
+#include <chrono>
+#include <cstdint>
+
+namespace frame {
+
+// Picks the fraction of the terminal's pixels that frames are rendered at
+// when it is left to adjust to the load. Painting that keeps taking longer
+// than |budget| steps the scale down, painting well within it steps the
+// scale back up, never leaving [|min_scale|, 1].
+class RenderScaler {
+ public:
+  explicit RenderScaler(
+      float min_scale = 0.5f,
+      std::chrono::microseconds budget = std::chrono::milliseconds(25));
+
+  // Counts a painted frame, returns true when the scale changed
+  bool Painted(std::chrono::microseconds paint_time);
+  float scale() const { return scale_; }
+
+ private:
+  static constexpr float kStep = 0.25f;
+  // frames in a row over or well under budget before the scale changes
+  static constexpr int kFramesToChange = 8;
+
+  const float min_scale_;
+  const int64_t budget_us_;
+  float scale_ = 1;
+  int over_ = 0;
+  int under_ = 0;
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_RENDER_SCALE_H
@@ -0,0 +1,46 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "render_scale.h"
+
+#include <gtest/gtest.h>
+
+using namespace frame;
+using std::chrono::milliseconds;
+
+TEST(RenderScalerTest, StepsDownUnderLoad) {
+  RenderScaler scaler(0.5f, milliseconds(25));
+  for (int i = 0; i < 7; ++i) EXPECT_FALSE(scaler.Painted(milliseconds(40)));
+  EXPECT_TRUE(scaler.Painted(milliseconds(40)));
+  EXPECT_EQ(scaler.scale(), 0.75f);
+
+  for (int i = 0; i < 7; ++i) scaler.Painted(milliseconds(40));
+  EXPECT_TRUE(scaler.Painted(milliseconds(40)));
+  EXPECT_EQ(scaler.scale(), 0.5f);
+
+  // never below the minimum
+  for (int i = 0; i < 16; ++i) EXPECT_FALSE(scaler.Painted(milliseconds(40)));
+  EXPECT_EQ(scaler.scale(), 0.5f);
+}
+
+TEST(RenderScalerTest, StepsBackUp) {
+  RenderScaler scaler(0.5f, milliseconds(25));
+  for (int i = 0; i < 8; ++i) scaler.Painted(milliseconds(40));
+  ASSERT_EQ(scaler.scale(), 0.75f);
+
+  // within budget, but not by enough to afford more pixels
+  for (int i = 0; i < 16; ++i) EXPECT_FALSE(scaler.Painted(milliseconds(20)));
+
+  for (int i = 0; i < 7; ++i) EXPECT_FALSE(scaler.Painted(milliseconds(5)));
+  EXPECT_TRUE(scaler.Painted(milliseconds(5)));
+  EXPECT_EQ(scaler.scale(), 1.0f);
+}
+
+TEST(RenderScalerTest, SpikesDoNotCount) {
+  RenderScaler scaler(0.5f, milliseconds(25));
+  for (int i = 0; i < 32; ++i) {
+    scaler.Painted(i % 4 ? milliseconds(10) : milliseconds(100));
+  }
+  EXPECT_EQ(scaler.scale(), 1.0f);
+}
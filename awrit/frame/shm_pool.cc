@@ -0,0 +1,163 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "shm_pool.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+
+#include "cleanup.h"
+
+namespace frame {
+
+namespace {
+
+#if defined(__linux__)
+constexpr bool kReusableNames = true;
+constexpr char kShmDir[] = "/dev/shm";
+#else
+constexpr bool kReusableNames = false;
+#endif
+
+constexpr char kNamePrefix[] = "awrit-";
+
+std::string NextName() {
+  static std::atomic<uint32_t> counter{0};
+  return "/" + std::string(kNamePrefix) + std::to_string(getpid()) + "-" +
+         std::to_string(counter++);
+}
+
+void Prefault(void* data, size_t size) {
+  const long page = sysconf(_SC_PAGESIZE);
+  auto* bytes = static_cast<volatile uint8_t*>(data);
+  for (size_t offset = 0; offset < size; offset += page) bytes[offset] = 0;
+}
+
+}  // namespace
+
+ShmPool::ShmPool(ShmPoolOptions options)
+    : options_(options), recycler_(options.timeout) {
+  if (options_.max_segments > kMaxRegistered)
+    options_.max_segments = kMaxRegistered;
+}
+
+ShmPool::~ShmPool() { Clear(); }
+
+bool ShmPool::HasReusableNames() { return kReusableNames; }
+
+size_t ShmPool::mapped_bytes() const {
+  size_t total = 0;
+  for (const auto& segment : segments_) total += segment->capacity;
+  return total;
+}
+
+ShmSegment* ShmPool::Acquire(size_t size) {
+  if (size == 0) return nullptr;
+
+  ShmSegment* result = recycler_.Pick(segments_, size);
+  if (!result) {
+    // every segment is in flight, the terminal may still be reading them
+    if (segments_.size() >= options_.max_segments) return nullptr;
+    auto segment = std::make_unique<ShmSegment>();
+    if (!Create(*segment, size)) return nullptr;
+    segments_.push_back(std::move(segment));
+    return segments_.back().get();
+  }
+
+  if (result->in_flight && !kReusableNames) {
+    // the terminal unlinked it, recreate it under a new name
+    size_t capacity = std::max(result->capacity, size);
+    Destroy(*result);
+    if (!Create(*result, capacity)) return nullptr;
+  } else if (result->capacity < size && !Grow(*result, size)) {
+    return nullptr;
+  }
+
+  result->in_flight = false;
+  return result;
+}
+
+void ShmPool::Clear() {
+  for (auto& segment : segments_) Destroy(*segment);
+  segments_.clear();
+}
+
+bool ShmPool::Create(ShmSegment& segment, size_t capacity) {
+  segment.name = NextName();
+  segment.fd = shm_open(segment.name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  if (segment.fd < 0) {
+    fprintf(stderr, "NO FD %s\r\n", segment.name.c_str());
+    return false;
+  }
+  Register(segment.name, NameKind::shm);
+#if defined(__linux__)
+  segment.path = kShmDir + segment.name;
+#endif
+
+  if (!Grow(segment, capacity)) {
+    Destroy(segment);
+    return false;
+  }
+  return true;
+}
+
+bool ShmPool::Grow(ShmSegment& segment, size_t capacity) {
+  if (segment.data) {
+    munmap(segment.data, segment.capacity);
+    segment.data = nullptr;
+    segment.capacity = 0;
+  }
+
+  if (ftruncate(segment.fd, capacity) < 0) {
+    fprintf(stderr, "BAD SIZE %zu\r\n", capacity);
+    return false;
+  }
+
+  int flags = MAP_SHARED;
+#if defined(__linux__)
+  if (!options_.huge_pages) flags |= MAP_POPULATE;
+#endif
+  void* data =
+      mmap(nullptr, capacity, PROT_READ | PROT_WRITE, flags, segment.fd, 0);
+  if (data == MAP_FAILED) {
+    fprintf(stderr, "MAP FAILED\r\n");
+    return false;
+  }
+
+#if defined(__linux__)
+  if (options_.huge_pages) {
+    madvise(data, capacity, MADV_HUGEPAGE);
+    Prefault(data, capacity);
+  }
+#else
+  Prefault(data, capacity);
+#endif
+
+  segment.data = data;
+  segment.capacity = capacity;
+  return true;
+}
+
+void ShmPool::Destroy(ShmSegment& segment) {
+  if (segment.data) munmap(segment.data, segment.capacity);
+  if (segment.fd >= 0) close(segment.fd);
+  if (!segment.name.empty()) {
+    shm_unlink(segment.name.c_str());
+    Unregister(segment.name);
+  }
+  segment = ShmSegment{};
+}
+
+void ShmPool::SweepStale() {
+#if defined(__linux__)
+  frame::SweepStale(kShmDir, kNamePrefix, NameKind::shm);
+#endif
+}
+
+}  // namespace frame
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_SHM_POOL_H
+#define AWRIT_FRAME_SHM_POOL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "recycler.h"
+
+namespace frame {
+
+struct ShmSegment : PooledBuffer {
+  // POSIX shared memory object name
+  std::string name;
+  // file system path of the same object, empty where there is none
+  std::string path;
+  void* data = nullptr;
+  int fd = -1;
+};
+
+struct ShmPoolOptions {
+  size_t max_segments = 32;
+  // after this long without an answer a segment is assumed read, see Recycler
+  Recycler::Clock::duration timeout = std::chrono::milliseconds(250);
+  // ask for transparent huge pages, only honored where shmem supports them
+  bool huge_pages = false;
+};
+
+// Pre-faulted shared memory segments that are recycled between frames instead
+// of being created and mapped for every upload. A segment is only written
+// again once the terminal acknowledged reading it, see Recycler.
+//
+// On Linux POSIX shared memory objects live in /dev/shm, so segments are
+// handed to the terminal by path as regular files, which the terminal does not
+// unlink after reading. Elsewhere the terminal unlinks every segment it reads
+// and a recycled segment has to be recreated under a new name.
+//
+// Segments are registered for cleanup, see cleanup.h.
+class ShmPool {
+ public:
+  explicit ShmPool(ShmPoolOptions options = {});
+  ~ShmPool();
+
+  ShmPool(const ShmPool&) = delete;
+  ShmPool& operator=(const ShmPool&) = delete;
+
+  // Whether segments survive being read by the terminal, see ShmSegment::path
+  static bool HasReusableNames();
+
+  // Returns a mapped segment of at least |size| bytes, nullptr on failure or
+  // when all |max_segments| are still in flight
+  ShmSegment* Acquire(size_t size);
+  // Marks |segment| as handed to the terminal, |acknowledge| when the command
+  // naming it asks for an answer
+  void Submit(ShmSegment* segment, bool acknowledge) {
+    recycler_.Submit(*segment, acknowledge);
+  }
+  // The terminal answered |count| more commands that asked for it
+  void Acknowledged(uint64_t count = 1) { recycler_.Acknowledged(count); }
+  // Makes every segment reusable, for when the terminal stopped answering
+  void ReleaseAll() {
+    for (auto& segment : segments_) recycler_.Release(*segment);
+  }
+  // Unlinks and unmaps every segment
+  void Clear();
+
+  size_t segment_count() const { return segments_.size(); }
+  size_t mapped_bytes() const;
+
+  // Removes segments left behind by awrit processes that no longer exist
+  static void SweepStale();
+
+ private:
+  ShmPoolOptions options_;
+  Recycler recycler_;
+  std::vector<std::unique_ptr<ShmSegment>> segments_;
+
+  bool Create(ShmSegment& segment, size_t capacity);
+  bool Grow(ShmSegment& segment, size_t capacity);
+  void Destroy(ShmSegment& segment);
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_SHM_POOL_H
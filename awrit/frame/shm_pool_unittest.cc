@@ -0,0 +1,127 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "shm_pool.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "cleanup.h"
+
+using namespace frame;
+
+namespace {
+bool Exists(const std::string& name) {
+  int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0) return false;
+  close(fd);
+  return true;
+}
+}  // namespace
+
+TEST(ShmPoolTest, AcquireMapsWritableSegment) {
+  ShmPool pool;
+  auto* segment = pool.Acquire(1000);
+  ASSERT_NE(segment, nullptr);
+  EXPECT_GE(segment->capacity, 1000u);
+  memset(segment->data, 0xab, 1000);
+  EXPECT_TRUE(Exists(segment->name));
+}
+
+TEST(ShmPoolTest, RecyclesOnceAcknowledged) {
+  ShmPool pool;
+
+  auto* first = pool.Acquire(4096);
+  pool.Submit(first, true);
+
+  // the terminal may still be reading the first one
+  auto* second = pool.Acquire(4096);
+  EXPECT_NE(first, second);
+  pool.Submit(second, true);
+
+  pool.Acknowledged();
+  auto* third = pool.Acquire(4096);
+  if (ShmPool::HasReusableNames()) {
+    EXPECT_EQ(third, first);
+  }
+  EXPECT_EQ(pool.segment_count(), 2u);
+}
+
+TEST(ShmPoolTest, GrowsOnlyWhenNeeded) {
+  ShmPool pool;
+  auto* segment = pool.Acquire(4096);
+  pool.Submit(segment, true);
+  pool.Acknowledged();
+
+  EXPECT_EQ(pool.Acquire(1024), segment);
+  EXPECT_EQ(segment->capacity, 4096u);
+  EXPECT_EQ(pool.Acquire(8192), segment);
+  EXPECT_EQ(segment->capacity, 8192u);
+  EXPECT_EQ(pool.mapped_bytes(), 8192u);
+}
+
+TEST(ShmPoolTest, NeverTakesSegmentsInFlight) {
+  ShmPoolOptions options;
+  options.max_segments = 2;
+  ShmPool pool(options);
+  for (int i = 0; i < 2; ++i) {
+    auto* segment = pool.Acquire(4096);
+    ASSERT_NE(segment, nullptr);
+    pool.Submit(segment, true);
+  }
+  EXPECT_EQ(pool.Acquire(4096), nullptr);
+  EXPECT_EQ(pool.segment_count(), 2u);
+
+  pool.Acknowledged();
+  EXPECT_NE(pool.Acquire(4096), nullptr);
+  EXPECT_EQ(pool.segment_count(), 2u);
+}
+
+TEST(ShmPoolTest, RecoversWithoutAnswers) {
+  ShmPoolOptions options;
+  options.max_segments = 2;
+  options.timeout = std::chrono::milliseconds(10);
+  ShmPool pool(options);
+  for (int i = 0; i < 2; ++i) pool.Submit(pool.Acquire(4096), false);
+  EXPECT_EQ(pool.Acquire(4096), nullptr);
+
+  std::this_thread::sleep_for(options.timeout);
+  EXPECT_NE(pool.Acquire(4096), nullptr);
+  EXPECT_EQ(pool.segment_count(), 2u);
+}
+
+TEST(ShmPoolTest, ReleasesAllOnceUnanswered) {
+  ShmPoolOptions options;
+  options.max_segments = 1;
+  ShmPool pool(options);
+  auto* segment = pool.Acquire(4096);
+  pool.Submit(segment, true);
+  EXPECT_EQ(pool.Acquire(4096), nullptr);
+
+  pool.ReleaseAll();
+  EXPECT_NE(pool.Acquire(4096), nullptr);
+}
+
+TEST(ShmPoolTest, ClearUnlinks) {
+  std::string name;
+  {
+    ShmPool pool;
+    name = pool.Acquire(4096)->name;
+    EXPECT_TRUE(Exists(name));
+  }
+  EXPECT_FALSE(Exists(name));
+}
+
+TEST(ShmPoolTest, UnlinkRegistered) {
+  ShmPool pool;
+  auto* segment = pool.Acquire(4096);
+  UnlinkRegistered();
+  EXPECT_FALSE(Exists(segment->name));
+}
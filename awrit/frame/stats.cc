@@ -0,0 +1,31 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "stats.h"
+
+namespace frame {
+
+namespace {
+const char* Format(const FrameStats& stats) {
+  if (stats.rects == 0) return "none";
+  if (stats.rgb_rects == stats.rects) return "rgb";
+  if (stats.rgb_rects == 0) return "rgba";
+  return "mixed";
+}
+}  // namespace
+
+std::string FormatStats(const FrameStats& stats) {
+  return "frame=" + std::to_string(stats.frame) +
+         " dropped=" + std::to_string(stats.dropped) +
+         " queue_us=" + std::to_string(stats.queue_us) +
+         " tile_size=" + std::to_string(stats.tile_size) +
+         " tiles_hashed=" + std::to_string(stats.tiles_hashed) +
+         " tiles_changed=" + std::to_string(stats.tiles_changed) +
+         " rects=" + std::to_string(stats.rects) +
+         " mode=" + (stats.full_frame ? "full" : "rects") +
+         " format=" + Format(stats) +
+         " bytes=" + std::to_string(stats.bytes);
+}
+
+}  // namespace frame
@@ -0,0 +1,37 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_STATS_H
+#define AWRIT_FRAME_STATS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace frame {
+
+// What painting a single frame did, for tuning
+struct FrameStats {
+  uint64_t frame = 0;
+  // frames replaced by this one before they could be painted
+  uint32_t dropped = 0;
+  // time the frame waited between being rendered and being painted
+  int64_t queue_us = 0;
+  int tile_size = 0;
+  size_t tiles_hashed = 0;
+  size_t tiles_changed = 0;
+  size_t rects = 0;
+  // rects sent as 24-bit RGB because they were opaque, the rest are RGBA
+  size_t rgb_rects = 0;
+  bool full_frame = false;
+  // pixel bytes handed to the terminal
+  size_t bytes = 0;
+};
+
+// Formats |stats| as a single logfmt line, without a trailing newline
+std::string FormatStats(const FrameStats& stats);
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_STATS_H
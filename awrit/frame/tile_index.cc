@@ -0,0 +1,195 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "tile_index.h"
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace frame {
+
+namespace {
+
+// The hash accumulates 32-byte stripes into four 64-bit lanes, mixing each
+// 64-bit word with a key that advances every stripe so that moving content
+// around within a tile changes the hash. The per-lane math only uses 32x32
+// multiplies and 64-bit adds, which map directly onto SSE2.
+constexpr size_t kStripe = 32;
+constexpr uint64_t kPrime1 = 0x9E3779B185EBCA87ULL;
+constexpr uint64_t kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+constexpr uint64_t kPrime3 = 0x165667B19E3779F9ULL;
+constexpr uint64_t kKeyBase[4] = {0xbe4ba423396cfeb8ULL, 0x1cad21f72c81017cULL,
+                                  0xdb979083e96dd4deULL, 0x1f67b3b7a4a44072ULL};
+constexpr uint64_t kKeyStep = kPrime3;
+
+uint64_t Avalanche(uint64_t h) {
+  h ^= h >> 37;
+  h *= kPrime2;
+  h ^= h >> 32;
+  return h;
+}
+
+uint64_t Finalize(const uint64_t acc[4], size_t length) {
+  uint64_t h = length * kPrime1;
+  for (int lane = 0; lane < 4; ++lane) {
+    h = (h ^ Avalanche(acc[lane] + lane * kPrime2)) * kPrime1;
+  }
+  return Avalanche(h);
+}
+
+struct ScalarState {
+  uint64_t acc[4] = {};
+  uint64_t key[4] = {kKeyBase[0], kKeyBase[1], kKeyBase[2], kKeyBase[3]};
+
+  void Stripe(const uint8_t* p) {
+    for (int lane = 0; lane < 4; ++lane) {
+      uint64_t d;
+      memcpy(&d, p + lane * 8, 8);
+      uint64_t k = d ^ key[lane];
+      acc[lane] += (k & 0xffffffff) * (k >> 32);
+      acc[lane] += d;
+      key[lane] += kKeyStep;
+    }
+  }
+
+  void Store(uint64_t out[4]) const { memcpy(out, acc, sizeof(acc)); }
+};
+
+#if defined(__SSE2__)
+struct SSE2State {
+  __m128i acc_lo = _mm_setzero_si128();
+  __m128i acc_hi = _mm_setzero_si128();
+  __m128i key_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kKeyBase));
+  __m128i key_hi =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(kKeyBase + 2));
+  const __m128i step = _mm_set1_epi64x(static_cast<long long>(kKeyStep));
+
+  static __m128i Lane(__m128i acc, __m128i d, __m128i key) {
+    __m128i k = _mm_xor_si128(d, key);
+    __m128i product = _mm_mul_epu32(k, _mm_srli_epi64(k, 32));
+    return _mm_add_epi64(_mm_add_epi64(acc, product), d);
+  }
+
+  void Stripe(const uint8_t* p) {
+    __m128i d_lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    __m128i d_hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16));
+    acc_lo = Lane(acc_lo, d_lo, key_lo);
+    acc_hi = Lane(acc_hi, d_hi, key_hi);
+    key_lo = _mm_add_epi64(key_lo, step);
+    key_hi = _mm_add_epi64(key_hi, step);
+  }
+
+  void Store(uint64_t out[4]) const {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out), acc_lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2), acc_hi);
+  }
+};
+#endif
+
+template <typename State>
+uint64_t Hash(const void* data, size_t row_bytes, size_t stride, int rows) {
+  State state;
+  const auto* row = static_cast<const uint8_t*>(data);
+  const size_t whole = row_bytes - row_bytes % kStripe;
+  for (int y = 0; y < rows; ++y, row += stride) {
+    for (size_t offset = 0; offset < whole; offset += kStripe) {
+      state.Stripe(row + offset);
+    }
+    if (whole != row_bytes) {
+      uint8_t tail[kStripe] = {};
+      memcpy(tail, row + whole, row_bytes - whole);
+      state.Stripe(tail);
+    }
+  }
+
+  uint64_t acc[4];
+  state.Store(acc);
+  return Finalize(acc, row_bytes * rows);
+}
+
+}  // namespace
+
+uint64_t HashTileScalar(const void* data, size_t row_bytes, size_t stride,
+                        int rows) {
+  return Hash<ScalarState>(data, row_bytes, stride, rows);
+}
+
+uint64_t HashTile(const void* data, size_t row_bytes, size_t stride,
+                  int rows) {
+#if defined(__SSE2__)
+  return Hash<SSE2State>(data, row_bytes, stride, rows);
+#else
+  return Hash<ScalarState>(data, row_bytes, stride, rows);
+#endif
+}
+
+TileIndex::TileIndex(int tile_size)
+    : tile_size_(tile_size > 0 ? tile_size : kDefaultTileSize) {}
+
+void TileIndex::Reset(Size size) {
+  size_ = size;
+  columns_ = (size.width + tile_size_ - 1) / tile_size_;
+  rows_ = (size.height + tile_size_ - 1) / tile_size_;
+  hashes_.assign(static_cast<size_t>(columns_) * rows_, 0);
+  known_.assign(hashes_.size(), false);
+}
+
+std::vector<Rect> TileIndex::Update(const void* pixels, Size size,
+                                    const std::vector<Rect>& damage) {
+  if (size != size_) Reset(size);
+
+  std::vector<bool> dirty(hashes_.size(), false);
+  const Rect bounds{0, 0, size.width, size.height};
+  for (const auto& rect : damage) {
+    Rect clipped = rect.Intersect(bounds);
+    if (clipped.IsEmpty()) continue;
+    for (int row = clipped.y / tile_size_;
+         row <= (clipped.Bottom() - 1) / tile_size_; ++row) {
+      for (int col = clipped.x / tile_size_;
+           col <= (clipped.Right() - 1) / tile_size_; ++col) {
+        dirty[row * columns_ + col] = true;
+      }
+    }
+  }
+
+  std::vector<Rect> changed;
+  const size_t stride = static_cast<size_t>(size.width) * sizeof(uint32_t);
+  const auto* base = static_cast<const uint8_t*>(pixels);
+  tiles_hashed_ = 0;
+  tiles_changed_ = 0;
+  for (int row = 0; row < rows_; ++row) {
+    Rect run;
+    for (int col = 0; col < columns_; ++col) {
+      size_t index = row * columns_ + col;
+      if (!dirty[index]) continue;
+
+      Rect tile =
+          Rect{col * tile_size_, row * tile_size_, tile_size_, tile_size_}
+              .Intersect(bounds);
+      uint64_t hash = HashTile(
+          base + tile.y * stride + tile.x * sizeof(uint32_t),
+          tile.width * sizeof(uint32_t), stride, tile.height);
+      ++tiles_hashed_;
+      if (known_[index] && hashes_[index] == hash) continue;
+
+      hashes_[index] = hash;
+      known_[index] = true;
+      ++tiles_changed_;
+      if (!run.IsEmpty() && run.Right() == tile.x) {
+        run = run.Union(tile);
+      } else {
+        if (!run.IsEmpty()) changed.push_back(run);
+        run = tile;
+      }
+    }
+    if (!run.IsEmpty()) changed.push_back(run);
+  }
+
+  return changed;
+}
+
+}  // namespace frame
@@ -0,0 +1,57 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_TILE_INDEX_H
+#define AWRIT_FRAME_TILE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "rect.h"
+
+namespace frame {
+
+// Hashes |rows| rows of |row_bytes| each, |stride| bytes apart
+uint64_t HashTile(const void* data, size_t row_bytes, size_t stride, int rows);
+// Reference implementation of HashTile, always produces the same result
+uint64_t HashTileScalar(const void* data, size_t row_bytes, size_t stride,
+                        int rows);
+
+// Keeps a content hash for every tile of the last transmitted frame so that
+// tiles that did not change can be skipped, even if they were reported dirty.
+class TileIndex {
+ public:
+  static constexpr int kDefaultTileSize = 64;
+
+  explicit TileIndex(int tile_size = kDefaultTileSize);
+
+  int tile_size() const { return tile_size_; }
+  // number of tiles hashed by the last Update
+  size_t tiles_hashed() const { return tiles_hashed_; }
+  // number of tiles found changed by the last Update
+  size_t tiles_changed() const { return tiles_changed_; }
+
+  // Forgets all hashes, every tile is considered changed on the next Update
+  void Reset(Size size);
+
+  // Rehashes the tiles of the 32-bit |pixels| overlapping |damage| and
+  // returns the tiles that changed, with changed neighbours in a row joined
+  std::vector<Rect> Update(const void* pixels, Size size,
+                           const std::vector<Rect>& damage);
+
+ private:
+  int tile_size_;
+  Size size_;
+  int columns_ = 0;
+  int rows_ = 0;
+  std::vector<uint64_t> hashes_;
+  std::vector<bool> known_;
+  size_t tiles_hashed_ = 0;
+  size_t tiles_changed_ = 0;
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_TILE_INDEX_H
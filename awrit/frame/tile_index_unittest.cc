@@ -0,0 +1,91 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "tile_index.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+using namespace frame;
+
+namespace {
+std::vector<uint32_t> Pattern(Size size) {
+  std::vector<uint32_t> pixels(size.width * size.height);
+  std::iota(pixels.begin(), pixels.end(), 0x10203040u);
+  return pixels;
+}
+}  // namespace
+
+TEST(TileHashTest, MatchesScalar) {
+  auto pixels = Pattern({100, 37});
+  for (int width : {1, 7, 8, 9, 64, 100}) {
+    size_t row_bytes = width * sizeof(uint32_t);
+    EXPECT_EQ(HashTile(pixels.data(), row_bytes, 400, 37),
+              HashTileScalar(pixels.data(), row_bytes, 400, 37))
+        << "width " << width;
+  }
+}
+
+TEST(TileHashTest, DetectsSwappedRows) {
+  std::vector<uint32_t> a = {1, 2,  3,  4,  5,  6,  7,  8,
+                             9, 10, 11, 12, 13, 14, 15, 16};
+  std::vector<uint32_t> b = {9, 10, 11, 12, 13, 14, 15, 16,
+                             1, 2,  3,  4,  5,  6,  7,  8};
+  EXPECT_NE(HashTile(a.data(), 32, 32, 2), HashTile(b.data(), 32, 32, 2));
+}
+
+TEST(TileIndexTest, FirstUpdateReportsEverything) {
+  Size size{100, 70};
+  auto pixels = Pattern(size);
+  TileIndex index(32);
+  auto changed = index.Update(pixels.data(), size, {{0, 0, 100, 70}});
+  std::vector<Rect> expected = {
+      {0, 0, 100, 32}, {0, 32, 100, 32}, {0, 64, 100, 6}};
+  EXPECT_EQ(changed, expected);
+  EXPECT_EQ(index.tiles_hashed(), 12u);
+}
+
+TEST(TileIndexTest, SkipsUnchangedTiles) {
+  Size size{128, 128};
+  auto pixels = Pattern(size);
+  TileIndex index(32);
+  index.Update(pixels.data(), size, {{0, 0, 128, 128}});
+
+  pixels[40 * 128 + 70] ^= 0xff;
+  auto changed = index.Update(pixels.data(), size, {{0, 0, 128, 128}});
+  std::vector<Rect> expected = {{64, 32, 32, 32}};
+  EXPECT_EQ(changed, expected);
+  EXPECT_EQ(index.tiles_changed(), 1u);
+
+  changed = index.Update(pixels.data(), size, {{0, 0, 128, 128}});
+  EXPECT_TRUE(changed.empty());
+}
+
+TEST(TileIndexTest, OnlyHashesDamagedTiles) {
+  Size size{128, 128};
+  auto pixels = Pattern(size);
+  TileIndex index(32);
+  index.Update(pixels.data(), size, {{0, 0, 128, 128}});
+
+  pixels[0] ^= 0xff;
+  pixels[127 * 128 + 127] ^= 0xff;
+  auto changed = index.Update(pixels.data(), size, {{120, 120, 8, 8}});
+  std::vector<Rect> expected = {{96, 96, 32, 32}};
+  EXPECT_EQ(changed, expected);
+  EXPECT_EQ(index.tiles_hashed(), 1u);
+}
+
+TEST(TileIndexTest, ResetsOnResize) {
+  Size size{64, 64};
+  auto pixels = Pattern(size);
+  TileIndex index(32);
+  index.Update(pixels.data(), size, {{0, 0, 64, 64}});
+
+  Size smaller{32, 64};
+  auto changed = index.Update(pixels.data(), smaller, {{0, 0, 32, 64}});
+  EXPECT_EQ(changed.size(), 2u);
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+// Measures the cost of getting a converted frame into a shared memory segment
+// and into a frame file, which is what each transport pays per frame:
+//   transport_bench [width] [height] [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "file_pool.h"
+#include "pixels.h"
+#include "shm_pool.h"
+
+namespace {
+
+void Measure(const char* name, size_t bytes, int iterations,
+             const std::function<bool()>& frame) {
+  if (!frame()) {
+    printf("%-5s failed\n", name);
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) frame();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  double per_frame_ms = elapsed.count() * 1000 / iterations;
+  double gib_per_s =
+      bytes * static_cast<double>(iterations) / elapsed.count() / (1 << 30);
+  printf("%-5s %8.3f ms/frame %8.2f GiB/s written\n", name, per_frame_ms,
+         gib_per_s);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int width = argc > 1 ? atoi(argv[1]) : 3840;
+  const int height = argc > 2 ? atoi(argv[2]) : 2160;
+  const int iterations = argc > 3 ? atoi(argv[3]) : 100;
+  const frame::Rect bounds{0, 0, width, height};
+  const size_t stride = width * 4;
+  const size_t bytes = bounds.Area() * 3;
+
+  // opaque so that every frame takes the RGB path
+  std::vector<uint8_t> src(bounds.Area() * 4);
+  for (size_t i = 0; i < src.size(); ++i) src[i] = i % 4 == 3 ? 0xff : i * 31;
+
+  frame::FilePool files;
+  printf("%dx%d RGB, %d iterations, files in %s\n", width, height, iterations,
+         files.dir().c_str());
+
+  // the terminal answers each frame a couple of frames later, so the pools
+  // keep a few buffers in rotation like the real pipeline does
+  constexpr int kFramesInFlight = 2;
+  frame::ShmPool pool;
+  int shm_frames = 0;
+  Measure("shm", bytes, iterations, [&] {
+    if (shm_frames++ >= kFramesInFlight) pool.Acknowledged();
+    auto* segment = pool.Acquire(bytes);
+    if (!segment) return false;
+    frame::CopyRectAsRGB(src.data(), stride, bounds, segment->data);
+    pool.Submit(segment, true);
+    return true;
+  });
+
+  int file_frames = 0;
+  Measure("file", bytes, iterations, [&] {
+    if (file_frames++ >= kFramesInFlight) files.Acknowledged();
+    auto* file = files.Acquire(bytes);
+    if (!file) return false;
+    frame::CopyRectAsRGB(src.data(), stride, bounds, file->data);
+    files.Submit(file, true);
+    return true;
+  });
+  return 0;
+}
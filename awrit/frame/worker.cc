@@ -0,0 +1,55 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "worker.h"
+
+namespace frame {
+
+Worker::Worker(size_t max_pending)
+    : max_pending_(max_pending ? max_pending : 1),
+      thread_(&Worker::Run, this) {}
+
+Worker::~Worker() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  changed_.notify_all();
+  thread_.join();
+}
+
+void Worker::Post(Task task) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this] { return tasks_.size() < max_pending_; });
+  tasks_.push_back(std::move(task));
+  changed_.notify_all();
+}
+
+void Worker::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  changed_.wait(lock, [this] { return tasks_.empty() && !running_; });
+}
+
+void Worker::Run() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    changed_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+    // pending tasks still run so that nothing already posted is lost
+    if (tasks_.empty()) return;
+
+    Task task = std::move(tasks_.front());
+    tasks_.pop_front();
+    running_ = true;
+    changed_.notify_all();
+
+    lock.unlock();
+    task();
+    lock.lock();
+
+    running_ = false;
+    changed_.notify_all();
+  }
+}
+
+}  // namespace frame
@@ -0,0 +1,48 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_FRAME_WORKER_H
+#define AWRIT_FRAME_WORKER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace frame {
+
+// A single thread running tasks in the order they were posted. At most
+// |max_pending| tasks wait at a time, Post blocks once that many are queued so
+// a slow consumer slows the producer down instead of growing the queue.
+class Worker {
+ public:
+  using Task = std::function<void()>;
+
+  explicit Worker(size_t max_pending = 2);
+  ~Worker();
+
+  Worker(const Worker&) = delete;
+  Worker& operator=(const Worker&) = delete;
+
+  void Post(Task task);
+  // Blocks until every posted task has run
+  void Flush();
+
+ private:
+  const size_t max_pending_;
+  std::mutex mutex_;
+  std::condition_variable changed_;
+  std::deque<Task> tasks_;
+  bool running_ = false;
+  bool stopping_ = false;
+  std::thread thread_;
+
+  void Run();
+};
+
+}  // namespace frame
+
+#endif  // AWRIT_FRAME_WORKER_H
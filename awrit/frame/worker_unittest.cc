@@ -0,0 +1,32 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "worker.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <vector>
+
+using namespace frame;
+
+TEST(WorkerTest, RunsTasksInOrder) {
+  std::vector<int> order;
+  Worker worker(2);
+  for (int i = 0; i < 100; ++i) {
+    worker.Post([&order, i] { order.push_back(i); });
+  }
+  worker.Flush();
+  ASSERT_EQ(order.size(), 100u);
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(order[i], i);
+}
+
+TEST(WorkerTest, RunsPendingTasksBeforeStopping) {
+  std::atomic<int> count{0};
+  {
+    Worker worker(4);
+    for (int i = 0; i < 4; ++i) worker.Post([&count] { ++count; });
+  }
+  EXPECT_EQ(count, 4);
+}
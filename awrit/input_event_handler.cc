@@ -4,32 +4,55 @@
 
 #include "input_event_handler.h"
 
+#include <chrono>
 #include <locale>
 #include <unordered_map>
+#include <vector>
 
 #include "awrit.h"
 #include "include/base/cef_bind.h"
 #include "include/base/cef_callback.h"
+#include "include/cef_command_line.h"
 #include "include/wrapper/cef_closure_task.h"
+#include "include/wrapper/cef_helpers.h"
 #include "output.h"
 #include "third_party/keycodes/keyboard_codes_posix.h"
+#include "tty/event_queue.h"
 #include "tty/input_event.h"
+#include "tty/key_coalescer.h"
 #include "tty/kitty_keys.h"
 #include "tty/mouse.h"
+#include "tty/mouse_coalescer.h"
+#include "tui.h"
 
-void InputEventParserImpl::HandleKey(const tty::keys::KeyEvent& key_event) {
+namespace {
+
+// enough for a full read of single byte keys
+using InputQueue = tty::EventQueue<InputEvent, 4096>;
+
+// a notch of the wheel
+constexpr int kWheelDelta = 25;
+
+// input is dropped rather than waiting longer for a stuck UI thread, which is
+// also what unblocks the input thread while the UI thread shuts down
+constexpr auto kMaxWaitForRoom = std::chrono::seconds(1);
+
+// events parsed on the input thread, drained on the UI thread
+InputQueue& GetInputQueue() {
+  static InputQueue queue;
+  return queue;
+}
+
+void SendKey(AwritClient* client, const tty::keys::KeyEvent& key_event) {
   using namespace tty::keys;
 
   if (key_event.modifiers == Modifiers::Ctrl && key_event.key == 'c' &&
       key_event.type == tty::keys::Event::Up) {
-    CefPostTask(
-        TID_UI,
-        base::BindOnce(&AwritClient::CloseAllBrowsers,
-                       AwritClient::GetInstance(), true));
+    client->CloseAllBrowsers(true);
     return;
   }
 
-  auto active = AwritClient::GetInstance()->Active();
+  auto active = client->Active();
   if (!active) return;
 
 #ifdef OS_MAC
@@ -338,10 +361,7 @@ if(['textarea', 'input'].includes(document.activeElement.tagName.toLowerCase()))
   }
 }
 
-void InputEventParserImpl::HandleMouse(
-    const tty::mouse::MouseEvent& mouse_event) {
-  auto active = AwritClient::GetInstance()->Active();
-  if (!active) return;
+CefMouseEvent ToCefMouseEvent(const tty::mouse::MouseEvent& mouse_event) {
   using namespace tty::mouse;
 
   CefMouseEvent event;
@@ -373,7 +393,15 @@ void InputEventParserImpl::HandleMouse(
   event.x = mouse_event.x;
   event.y = mouse_event.y;
 #endif
+  return event;
+}
 
+void SendMouse(AwritClient* client, const tty::mouse::MouseEvent& mouse_event) {
+  auto active = client->Active();
+  if (!active) return;
+  using namespace tty::mouse;
+
+  auto event = ToCefMouseEvent(mouse_event);
   if (mouse_event.type == Event::Type::Move) {
     active->GetHost()->SendMouseMoveEvent(event, false);
   } else if (mouse_event.buttons &
@@ -386,10 +414,155 @@ void InputEventParserImpl::HandleMouse(
   } else if (mouse_event.buttons & Button::WheelUp ||
              mouse_event.buttons & Button::WheelDown) {
     active->GetHost()->SendMouseWheelEvent(
-        event, 0, mouse_event.buttons & Button::WheelUp ? 25 : -25);
+        event, 0,
+        mouse_event.buttons & Button::WheelUp ? kWheelDelta : -kWheelDelta);
   } else if (mouse_event.buttons & Button::WheelLeft ||
              mouse_event.buttons & Button::WheelRight) {
     active->GetHost()->SendMouseWheelEvent(
-        event, mouse_event.buttons & Button::WheelLeft ? -25 : 25, 0);
+        event,
+        mouse_event.buttons & Button::WheelLeft ? -kWheelDelta : kWheelDelta,
+        0);
+  }
+}
+
+// moves and wheel notches held back until the next frame
+tty::mouse::Coalescer& GetCoalescer() {
+  static tty::mouse::Coalescer coalescer;
+  return coalescer;
+}
+
+void SendHeldMouse(AwritClient* client) {
+  auto& coalescer = GetCoalescer();
+  if (coalescer.empty()) return;
+  auto held = coalescer.Take();
+  auto active = client->Active();
+  if (!active) return;
+
+  if (held.move) {
+    active->GetHost()->SendMouseMoveEvent(ToCefMouseEvent(*held.move), false);
+  }
+  if (held.wheel && (held.wheel_x || held.wheel_y)) {
+    active->GetHost()->SendMouseWheelEvent(ToCefMouseEvent(*held.wheel),
+                                           held.wheel_x * kWheelDelta,
+                                           held.wheel_y * kWheelDelta);
+  }
+}
+
+// Sends a run of keys that arrived together, coalesced while input lags
+void SendKeys(AwritClient* client,
+              const std::vector<tty::keys::KeyEvent>& keys) {
+  // inserting text skips the key events pages may listen to, so it is opt-in
+  static const bool commit_typing =
+      CefCommandLine::GetGlobalCommandLine()->HasSwitch("commit-typing");
+  static std::vector<tty::keys::KeyAction> actions;
+  tty::keys::CoalesceKeys(keys, commit_typing, actions);
+  for (const auto& action : actions) {
+    if (action.text.empty()) {
+      SendKey(client, action.event);
+    } else if (auto active = client->Active()) {
+      active->GetHost()->ImeCommitText(CefString(action.text),
+                                       CefRange::InvalidRange(), 0);
+    }
+  }
+}
+
+// Inserts pasted text as a single commit, rather than a key event for every
+// character
+void SendPaste(AwritClient* client, std::string& text) {
+  auto active = client->Active();
+  if (!active) return;
+  // terminals send line breaks as carriage returns, the parser keeps a CRLF
+  // within one piece
+  size_t end = 0;
+  for (size_t i = 0; i < text.size(); ++i) {
+    if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n') {
+      continue;
+    }
+    text[end++] = text[i] == '\r' ? '\n' : text[i];
   }
+  text.resize(end);
+  active->GetHost()->ImeCommitText(CefString(text), CefRange::InvalidRange(),
+                                   0);
+}
+
+// Sends every queued event to the active browser, on the UI thread
+void DispatchInput() {
+  auto& queue = GetInputQueue();
+  queue.BeginDrain();
+  auto* client = AwritClient::GetInstance();
+  // keys in a row, sent together to coalesce them
+  static std::vector<tty::keys::KeyEvent> keys;
+  keys.clear();
+  InputEvent event;
+  while (queue.Pop(event)) {
+    if (!client) continue;
+    if (auto* key_event = std::get_if<tty::keys::KeyEvent>(&event)) {
+      keys.push_back(*key_event);
+      continue;
+    }
+    auto* mouse_event = std::get_if<tty::mouse::MouseEvent>(&event);
+    if (mouse_event && keys.empty() && GetCoalescer().Add(*mouse_event)) {
+      continue;
+    }
+
+    // everything else is sent in order after what was held back
+    SendHeldMouse(client);
+    SendKeys(client, keys);
+    keys.clear();
+    if (!mouse_event) {
+      SendPaste(client, std::get<PasteEvent>(event).text);
+    } else if (!GetCoalescer().Add(*mouse_event)) {
+      SendMouse(client, *mouse_event);
+    }
+  }
+  if (client && !keys.empty()) {
+    SendHeldMouse(client);
+    SendKeys(client, keys);
+  }
+}
+
+}  // namespace
+
+void SendHeldInput() {
+  CEF_REQUIRE_UI_THREAD();
+  if (auto* client = AwritClient::GetInstance()) SendHeldMouse(client);
+}
+
+bool InputEventParserImpl::Flush() {
+  if (!queued_) return true;
+  queued_ = false;
+  if (auto* client = AwritClient::GetInstance()) client->OnInput();
+  if (!GetInputQueue().ScheduleDrain()) return true;
+  return CefPostTask(TID_UI, base::BindOnce(&DispatchInput));
+}
+
+void InputEventParserImpl::Queue(InputEvent event) {
+  auto& queue = GetInputQueue();
+  // the UI thread fell behind, hand it what is queued and wait until its
+  // drain makes room
+  while (!queue.Push(std::move(event))) {
+    if (!Flush() || !queue.WaitForRoom(kMaxWaitForRoom)) return;
+  }
+  queued_ = true;
+}
+
+void InputEventParserImpl::HandleKey(const tty::keys::KeyEvent& key_event) {
+  Queue(key_event);
+}
+
+void InputEventParserImpl::HandleMouse(
+    const tty::mouse::MouseEvent& mouse_event) {
+  Queue(mouse_event);
+}
+
+void InputEventParserImpl::HandlePaste(std::string_view text, bool) {
+  if (text.empty()) return;
+  Queue(PasteEvent{std::string(text)});
+  // a long paste reaches the page piece by piece as it arrives
+  Flush();
+}
+
+void InputEventParserImpl::HandleGraphicsReply(
+    const tty::graphics::Reply& reply) {
+  OnGraphicsReply(reply.image_id, reply.ok);
 }
@@ -5,12 +5,44 @@
 #ifndef AWRIT_INPUT_EVENT_HANDLER_H
 #define AWRIT_INPUT_EVENT_HANDLER_H
 
+#include <string>
+#include <string_view>
+#include <variant>
+
 #include "tty/input_event.h"
 
+// A piece of pasted text
+struct PasteEvent {
+  std::string text;
+};
+
+// An event on its way from the input thread to the UI thread
+using InputEvent =
+    std::variant<tty::keys::KeyEvent, tty::mouse::MouseEvent, PasteEvent>;
+
+// Parses input on the input thread and queues the events for the UI thread,
+// which sends them to the browser
 class InputEventParserImpl : public tty::InputEventParser {
+public:
+  // Hands the events parsed since the last call to the UI thread in a single
+  // task, false once the UI thread is gone
+  bool Flush();
+
 protected:
   void HandleKey(const tty::keys::KeyEvent& key_event) override;
   void HandleMouse(const tty::mouse::MouseEvent& key_event) override;
+  void HandleGraphicsReply(const tty::graphics::Reply& reply) override;
+  void HandlePaste(std::string_view text, bool last) override;
+
+private:
+  void Queue(InputEvent event);
+
+  // events were queued since the last Flush
+  bool queued_ = false;
 };
 
+// Sends the mouse moves and wheel notches held back since the last frame, on
+// the UI thread before each frame
+void SendHeldInput();
+
 #endif  // AWRIT_INPUT_EVENT_HANDLER_H
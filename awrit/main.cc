@@ -24,6 +24,32 @@ extern void MacCleanup();
 #include <unistd.h>
 #endif
 
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+namespace {
+// Parses the |name| switch into |value| as a whole number of at least |min|.
+// Anything else is reported and leaves |value| as it was.
+bool ParseIntSwitch(const CefRefPtr<CefCommandLine>& command_line,
+                    const char* name, int min, int& value) {
+  if (!command_line->HasSwitch(name)) return false;
+  std::string text = command_line->GetSwitchValue(name).ToString();
+  const char* end = text.data() + text.size();
+  int parsed = 0;
+  auto result = std::from_chars(text.data(), end, parsed);
+  if (result.ec != std::errc() || result.ptr != end || parsed < min) {
+    fprintf(stderr, "Ignoring --%s=%s, expected a whole number from %d\r\n",
+            name, text.c_str(), min);
+    return false;
+  }
+  value = parsed;
+  return true;
+}
+}  // namespace
+
 int main(int argc, char* argv[]) {
 #if defined(OS_MAC)
   CefScopedLibraryLoader library_loader;
@@ -68,8 +94,50 @@ int main(int argc, char* argv[]) {
   settings.no_sandbox = true;
 #endif
 
-  Initialize();
-  CefRefPtr<Awrit> app(new Awrit);
+  PaintOptions paint_options;
+  ParseIntSwitch(command_line, "tile-size", 1, paint_options.tile_size);
+  if (command_line->HasSwitch("paint-stats")) {
+    paint_options.stats_path =
+        command_line->GetSwitchValue("paint-stats").ToString();
+  }
+  if (command_line->HasSwitch("metrics")) {
+    paint_options.metrics_target =
+        command_line->GetSwitchValue("metrics").ToString();
+  }
+  paint_options.shm_huge_pages = command_line->HasSwitch("shm-huge-pages");
+  auto transport = command_line->GetSwitchValue("transport").ToString();
+  if (transport == "shm") {
+    paint_options.transport = Transport::shm;
+  } else if (transport == "file") {
+    paint_options.transport = Transport::file;
+  } else if (transport == "direct") {
+    paint_options.transport = Transport::direct;
+  }
+  if (command_line->HasSwitch("render-scale")) {
+    auto scale = command_line->GetSwitchValue("render-scale").ToString();
+    if (scale == "auto") {
+      paint_options.render_scale = 0;
+    } else if (float value = std::strtof(scale.c_str(), nullptr); value > 0) {
+      paint_options.render_scale = value;
+    }
+  }
+  if (!cacheDir.empty()) {
+    paint_options.probe_cache_path = cacheDir + "/awrit/terminal_graphics";
+  }
+
+  frame::GovernorOptions governor_options;
+  int idle_after_ms;
+  if (ParseIntSwitch(command_line, "idle-after", 1, idle_after_ms)) {
+    governor_options.idle_after = std::chrono::milliseconds(idle_after_ms);
+  }
+  // 0 never pauses
+  int pause_after_ms;
+  if (ParseIntSwitch(command_line, "pause-after", 0, pause_after_ms)) {
+    governor_options.pause_after = std::chrono::milliseconds(pause_after_ms);
+  }
+
+  Initialize(paint_options);
+  CefRefPtr<Awrit> app(new Awrit(governor_options));
   CefInitialize(main_args, settings, app.get(), win_sandbox_info);
   CefRunMessageLoop();
   CefShutdown();
@@ -0,0 +1,243 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+// Feeds synthetic or recorded frames through the paint pipeline, without CEF
+// or a terminal, and reports the frame rate, bytes per frame and the latency
+// of each stage:
+//   awrit_paint_bench [--width=<px>] [--height=<px>] [--frames=<n>]
+//                     [--damage=<fraction>] [--transport=<shm|file|direct>]
+//                     [--output=<path|->]
+//   awrit_paint_bench --replay=<journal> [--realtime] [--frames=<n>]
+//                     [--transport=<shm|file|direct>] [--output=<path|->]
+//
+// Every synthetic frame moves a box whose sides are |damage| of the frame's,
+// 1 changes the whole frame. A journal recorded with `awrit --record` is
+// replayed as fast as possible, or with its original timing given --realtime.
+// The graphics commands go to /dev/null unless |output| says otherwise, -
+// keeps stdout so they can be piped or shown by the terminal, the report goes
+// to stderr.
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "frame/journal.h"
+#include "frame/metrics.h"
+#include "frame/pacer.h"
+#include "painter.h"
+#include "tty/output.h"
+
+namespace {
+
+struct BenchOptions {
+  int width = 1920;
+  int height = 1080;
+  // all of a journal, or this many synthetic frames
+  int frames = 0;
+  float damage = 0.25f;
+  Transport transport = Transport::shm;
+  std::string output = "/dev/null";
+  std::string replay;
+  bool realtime = false;
+};
+
+constexpr int kSyntheticFrames = 300;
+
+bool ParseArgs(int argc, char* argv[], BenchOptions& options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    auto eq = arg.find('=');
+    std::string name = arg.substr(0, eq);
+    std::string value = eq == std::string::npos ? "" : arg.substr(eq + 1);
+    if (name == "--width") {
+      options.width = atoi(value.c_str());
+    } else if (name == "--height") {
+      options.height = atoi(value.c_str());
+    } else if (name == "--frames") {
+      options.frames = atoi(value.c_str());
+    } else if (name == "--damage") {
+      options.damage = strtof(value.c_str(), nullptr);
+    } else if (name == "--transport" && value == "shm") {
+      options.transport = Transport::shm;
+    } else if (name == "--transport" && value == "file") {
+      options.transport = Transport::file;
+    } else if (name == "--transport" && value == "direct") {
+      options.transport = Transport::direct;
+    } else if (name == "--output") {
+      options.output = value;
+    } else if (name == "--replay") {
+      options.replay = value;
+    } else if (name == "--realtime") {
+      options.realtime = true;
+    } else {
+      fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+      return false;
+    }
+  }
+  return options.width > 0 && options.height > 0 && options.frames >= 0 &&
+         options.damage > 0 && options.damage <= 1;
+}
+
+// Fills |rect| with a pattern that differs from frame to frame, so that every
+// tile under it has changed
+void Fill(frame::FrameMailbox::Frame& frame, const frame::Rect& rect,
+          uint32_t seed) {
+  auto* pixels = reinterpret_cast<uint32_t*>(frame.pixels.data());
+  for (int y = rect.y; y < rect.y + rect.height; ++y) {
+    uint32_t* row = pixels + static_cast<size_t>(y) * frame.size.width;
+    for (int x = rect.x; x < rect.x + rect.width; ++x) {
+      row[x] = 0xff000000u | ((x * 7 + y * 13 + seed * 101) & 0xffffffu);
+    }
+  }
+}
+
+// A box walking over the frame, the first frame is painted whole
+class Synthetic {
+ public:
+  explicit Synthetic(const BenchOptions& options) {
+    frame_.size = {options.width, options.height};
+    frame_.pixels.resize(static_cast<size_t>(options.width) * options.height *
+                         sizeof(uint32_t));
+    box_.width = std::max(1, static_cast<int>(options.width * options.damage));
+    box_.height =
+        std::max(1, static_cast<int>(options.height * options.damage));
+  }
+
+  void Next() {
+    const int width = frame_.size.width;
+    const int height = frame_.size.height;
+    if (count_ == 0) {
+      Fill(frame_, {0, 0, width, height}, 0);
+      frame_.dirty = {{0, 0, width, height}};
+    } else {
+      frame::Rect moved = box_;
+      moved.x = (count_ * 37) % std::max(1, width - box_.width + 1);
+      moved.y = (count_ * 23) % std::max(1, height - box_.height + 1);
+      Fill(frame_, moved, count_);
+      frame_.dirty = {box_.Union(moved)};
+      box_ = moved;
+    }
+    frame_.posted = std::chrono::steady_clock::now();
+    ++count_;
+  }
+
+  const frame::FrameMailbox::Frame& frame() const { return frame_; }
+
+ private:
+  frame::FrameMailbox::Frame frame_;
+  frame::Rect box_;
+  int count_ = 0;
+};
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  BenchOptions options;
+  if (!ParseArgs(argc, argv, options)) {
+    fprintf(stderr,
+            "Usage: %s [--width=<px>] [--height=<px>] [--frames=<n>] "
+            "[--damage=<fraction>] [--transport=<shm|file|direct>] "
+            "[--output=<path|->] [--replay=<journal>] [--realtime]\n",
+            argv[0]);
+    return 1;
+  }
+  if (options.output != "-") {
+    int fd = open(options.output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || dup2(fd, STDOUT_FILENO) < 0) {
+      fprintf(stderr, "Failed to open %s: %s\n", options.output.c_str(),
+              strerror(errno));
+      return 1;
+    }
+    close(fd);
+  }
+
+  frame::JournalReader journal;
+  if (!options.replay.empty() && !journal.Open(options.replay)) return 1;
+  Synthetic synthetic(options);
+  const bool replay = !options.replay.empty();
+  const int limit = options.frames ? options.frames
+                    : replay       ? INT_MAX
+                                   : kSyntheticFrames;
+
+  // nothing reads the frames, so each is answered as soon as it is painted
+  frame::FramePacer pacer;
+  std::atomic<uint64_t> answers{0};
+  PainterOptions painter_options;
+  painter_options.transport = options.transport;
+  painter_options.pacer = &pacer;
+  painter_options.answers = &answers;
+  Painter painter(painter_options);
+  auto answer = [&pacer, &answers] {
+    while (pacer.acknowledged() < pacer.sent()) pacer.Acknowledged(true);
+    answers = pacer.acknowledged();
+  };
+  frame::metrics::Enable(true);
+
+  const char* transport_name = options.transport == Transport::direct ? "direct"
+                               : options.transport == Transport::file ? "file"
+                                                                      : "shm";
+  if (replay) {
+    fprintf(stderr, "%s%s, %s to %s\n", options.replay.c_str(),
+            options.realtime ? " in real time" : "", transport_name,
+            options.output.c_str());
+  } else {
+    fprintf(stderr, "%dx%d, %d frames, damage %.2f, %s to %s\n",
+            options.width, options.height, limit, options.damage,
+            transport_name, options.output.c_str());
+  }
+
+  int painted = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (; painted < limit; ++painted) {
+    if (!replay) {
+      synthetic.Next();
+      painter.Paint(synthetic.frame());
+      answer();
+      continue;
+    }
+    if (!journal.Next()) break;
+    if (options.realtime) {
+      std::this_thread::sleep_until(
+          start + std::chrono::microseconds(journal.time_us()));
+    }
+    painter.Paint(journal.frame());
+    answer();
+  }
+  painter.Flush();
+  tty::out::Flush();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  using frame::metrics::Counter;
+  using frame::metrics::Stage;
+  const double frames = std::max(painted, 1);
+  fprintf(stderr,
+          "%.1f frames/s, %.0f pixel bytes/frame, %.0f tty bytes/frame\n",
+          frames / elapsed.count(),
+          frame::metrics::GetCounter(Counter::pixel_bytes) / frames,
+          frame::metrics::GetCounter(Counter::tty_bytes) / frames);
+  fprintf(stderr, "%-10s %8s %10s %10s\n", "stage", "count", "p50 us",
+          "p99 us");
+  for (auto stage : {Stage::paint, Stage::convert, Stage::shm, Stage::file,
+                     Stage::compress, Stage::enqueue, Stage::tty_write}) {
+    const auto& histogram = frame::metrics::GetHistogram(stage);
+    if (histogram.count() == 0) continue;
+    fprintf(stderr, "%-10s %8llu %10llu %10llu\n",
+            frame::metrics::StageName(stage),
+            static_cast<unsigned long long>(histogram.count()),
+            static_cast<unsigned long long>(histogram.Percentile(0.5)),
+            static_cast<unsigned long long>(histogram.Percentile(0.99)));
+  }
+  return 0;
+}
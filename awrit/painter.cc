@@ -0,0 +1,377 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "painter.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "frame/compress.h"
+#include "frame/damage.h"
+#include "frame/metrics.h"
+#include "frame/pixels.h"
+
+namespace {
+
+// the main view is always displayed under the same image and placement ids so
+// that damaged rects can be edited in place, and so that a new full frame
+// replaces the old one in the terminal instead of piling up next to it
+constexpr uint32_t kViewPlacementId = 1;
+// popups are an image of their own above the view, so that showing or
+// scrolling one never touches the view's pixels
+constexpr uint32_t kPopupPlacementId = 1;
+constexpr int kPopupZIndex = 1;
+
+// Direct frames queued for the tty beyond this wait for the terminal
+constexpr size_t kMaxQueuedGraphics = 8 * 1024 * 1024;
+
+tty::out::Placement ViewPlacement(bool acknowledge) {
+  tty::out::Placement display;
+  display.image_id = Painter::kViewImageId;
+  display.placement_id = kViewPlacementId;
+  display.acknowledge = acknowledge;
+  return display;
+}
+
+void CountRect(frame::FrameStats& stats, frame::PixelFormat format,
+               size_t size) {
+  ++stats.rects;
+  stats.rgb_rects += format == frame::PixelFormat::RGB;
+  stats.bytes += size;
+  frame::metrics::Add(frame::metrics::Counter::pixel_bytes, size);
+}
+
+}  // namespace
+
+Painter::Painter(const PainterOptions& options)
+    : transport_(options.transport),
+      pacer_(options.pacer),
+      answers_(options.answers),
+      tiles_(options.tile_size) {
+  switch (transport_) {
+    case Transport::direct:
+      worker_ = std::make_unique<frame::Worker>();
+      break;
+    case Transport::file:
+      files_ = std::make_unique<frame::FilePool>();
+      break;
+    default: {
+      frame::ShmPoolOptions pool_options;
+      pool_options.huge_pages = options.shm_huge_pages;
+      pool_ = std::make_unique<frame::ShmPool>(pool_options);
+      break;
+    }
+  }
+}
+
+// the worker may still be writing rects that refer to |compressed_|
+Painter::~Painter() { worker_.reset(); }
+
+// Converts |rect| of the BGRA |buffer| into |dest|. Opaque pixels are sent
+// as 24-bit RGB, which cuts a quarter of the bytes every later stage touches.
+// The RGB kernel gives up at the first row with a translucent pixel, so once
+// a frame turns out translucent RGBA is used until a frame is opaque again.
+frame::PixelFormat Painter::ConvertRect(const void* buffer, int width,
+                                        const frame::Rect& rect, void* dest) {
+  frame::metrics::Timer timer(frame::metrics::Stage::convert);
+  const size_t stride = width * sizeof(uint32_t);
+  if (!translucent_ && frame::CopyRectAsRGB(buffer, stride, rect, dest)) {
+    return frame::PixelFormat::RGB;
+  }
+  translucent_ = !frame::CopyRectAsRGBA(buffer, stride, rect, dest);
+  return frame::PixelFormat::RGBA;
+}
+
+namespace {
+void SendBitmap(const tty::out::Source& source, const frame::Rect& rect,
+                bool edit, const tty::out::Placement& display) {
+  frame::metrics::Timer timer(frame::metrics::Stage::enqueue);
+  if (edit) {
+    tty::out::EditBitmap(source, {rect.width, rect.height}, {rect.x, rect.y},
+                         display.image_id, display.acknowledge);
+  } else {
+    tty::out::PaintBitmap(source, {rect.width, rect.height}, display);
+  }
+}
+}  // namespace
+
+// Converts |rect| on the calling thread, since |buffer| is reused for the next
+// frame, and leaves compressing and writing it to the worker
+bool Painter::SendDirect(const void* buffer, int width,
+                         const Placement& placement,
+                         frame::FrameStats& stats) {
+  const auto& rect = placement.rect;
+  std::string pixels(rect.Area() * sizeof(uint32_t), '\0');
+  auto format = ConvertRect(buffer, width, rect, pixels.data());
+  pixels.resize(rect.Area() * frame::BytesPerPixel(format));
+  CountRect(stats, format, pixels.size());
+
+  worker_->Post([this, pixels = std::move(pixels), format, placement] {
+    bool compressed;
+    {
+      frame::metrics::Timer timer(frame::metrics::Stage::compress);
+      compressed = frame::Compress(pixels.data(), pixels.size(), compressed_);
+    }
+    if (!compressed) {
+      fprintf(stderr, "Failed to compress frame\r\n");
+      return;
+    }
+    tty::out::Source source{compressed_, tty::out::NameType::direct,
+                            static_cast<tty::out::Format>(format)};
+    source.compressed = true;
+    SendBitmap(source, placement.rect, placement.edit, placement.display);
+    // holds the worker back while a slow link is still writing older frames
+    tty::out::WaitForGraphicsBelow(kMaxQueuedGraphics);
+  });
+  return true;
+}
+
+bool Painter::SendShm(const void* buffer, int width,
+                      const Placement& placement, frame::FrameStats& stats) {
+  const auto& rect = placement.rect;
+  frame::ShmSegment* segment;
+  {
+    frame::metrics::Timer timer(frame::metrics::Stage::shm);
+    segment = pool_->Acquire(rect.Area() * sizeof(uint32_t));
+  }
+  if (!segment) return false;
+
+  auto format = ConvertRect(buffer, width, rect, segment->data);
+  size_t size = rect.Area() * frame::BytesPerPixel(format);
+  SendBitmap(SourceFor(*segment, size, format), rect, placement.edit,
+             placement.display);
+  pool_->Submit(segment, placement.display.acknowledge);
+  CountRect(stats, format, size);
+  return true;
+}
+
+bool Painter::SendFile(const void* buffer, int width,
+                       const Placement& placement, frame::FrameStats& stats) {
+  const auto& rect = placement.rect;
+  frame::FrameFile* file;
+  {
+    frame::metrics::Timer timer(frame::metrics::Stage::file);
+    file = files_->Acquire(rect.Area() * sizeof(uint32_t));
+  }
+  if (!file) return false;
+
+  auto format = ConvertRect(buffer, width, rect, file->data);
+  size_t size = rect.Area() * frame::BytesPerPixel(format);
+  SendBitmap(SourceFor(*file, size, format), rect, placement.edit,
+             placement.display);
+  files_->Submit(file, placement.display.acknowledge);
+  CountRect(stats, format, size);
+  return true;
+}
+
+// Segments and files are written again only once the terminal answered the
+// command that used them, or a later one. A terminal that the pacer found to
+// not answer at all is assumed done with everything of the previous frames.
+void Painter::ReleaseAcknowledged() {
+  if (pacer_ && !pacer_->pacing()) {
+    if (pool_) pool_->ReleaseAll();
+    if (files_) files_->ReleaseAll();
+  }
+  if (!answers_) return;
+  uint64_t acknowledged = *answers_;
+  if (pool_) pool_->Acknowledged(acknowledged - acknowledged_);
+  if (files_) files_->Acknowledged(acknowledged - acknowledged_);
+  acknowledged_ = acknowledged;
+}
+
+bool Painter::SendRect(const void* buffer, int width,
+                       const Placement& placement, frame::FrameStats& stats) {
+  bool sent;
+  switch (transport_) {
+    case Transport::direct:
+      sent = SendDirect(buffer, width, placement, stats);
+      break;
+    case Transport::file:
+      sent = SendFile(buffer, width, placement, stats);
+      break;
+    default:
+      sent = SendShm(buffer, width, placement, stats);
+      break;
+  }
+  // popups are answered too, but only frames of the view are paced
+  if (sent && placement.display.acknowledge && pacer_ &&
+      placement.display.image_id == kViewImageId) {
+    pacer_->Sent();
+  }
+  return sent;
+}
+
+// Brackets the commands of a frame so the terminal shows it at once. Direct
+// rects are written by the worker, so the markers have to queue behind them.
+void Painter::BeginUpdate() {
+  if (worker_) {
+    worker_->Post(tty::out::BeginSynchronizedUpdate);
+  } else {
+    tty::out::BeginSynchronizedUpdate();
+  }
+}
+
+void Painter::EndUpdate() {
+  if (worker_) {
+    worker_->Post(tty::out::EndSynchronizedUpdate);
+  } else {
+    tty::out::EndSynchronizedUpdate();
+  }
+}
+
+// Frees an image in the terminal
+void Painter::SendDelete(uint32_t image_id) {
+  if (worker_) {
+    worker_->Post([image_id] { tty::out::DeleteImage(image_id); });
+  } else {
+    tty::out::DeleteImage(image_id);
+  }
+}
+
+bool Painter::PaintFullFrame(const void* buffer, int width, int height,
+                             frame::FrameStats& stats) {
+  const frame::Rect bounds{0, 0, width, height};
+  Placement placement{bounds, false, ViewPlacement(true)};
+  // rendered below the window's size, or just behind a resize
+  auto window = tty::out::WindowSize();
+  if (window.width != width || window.height != height)
+    placement.display.cells = tty::out::WindowCells();
+
+  BeginUpdate();
+  // rather than relying on the replacement, the terminal is told that the
+  // data of an image that is gone for good can be freed
+  if (width_ && (width_ != width || height_ != height)) stale_image_ = true;
+  if (stale_image_) SendDelete(kViewImageId);
+  stale_image_ = false;
+  bool sent = SendRect(buffer, width, placement, stats);
+  EndUpdate();
+  if (!sent) return false;
+  width_ = width;
+  height_ = height;
+  has_frame_ = true;
+  stats.full_frame = true;
+  return true;
+}
+
+bool Painter::PaintRects(const std::vector<frame::Rect>& rects,
+                         const void* buffer, int width,
+                         frame::FrameStats& stats) {
+  BeginUpdate();
+  for (const auto& rect : rects) {
+    bool last = &rect == &rects.back();
+    if (!SendRect(buffer, width, {rect, true, ViewPlacement(last)}, stats)) {
+      // the terminal may now hold a partially updated frame
+      has_frame_ = false;
+      EndUpdate();
+      return false;
+    }
+  }
+  EndUpdate();
+  return true;
+}
+
+frame::FrameStats Painter::Paint(const frame::FrameMailbox::Frame& frame) {
+  frame::metrics::Timer timer(frame::metrics::Stage::paint);
+  ReleaseAcknowledged();
+  const void* buffer = frame.pixels.data();
+  const frame::Size size = frame.size;
+  const int width = size.width;
+  const int height = size.height;
+  const frame::Rect bounds{0, 0, width, height};
+  frame::FrameStats stats;
+  stats.frame = ++frames_;
+  stats.tile_size = tiles_.tile_size();
+  stats.dropped = frame.dropped;
+  stats.queue_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                       std::chrono::steady_clock::now() - frame.posted)
+                       .count();
+  frame::metrics::Record(frame::metrics::Stage::frame_wait, stats.queue_us);
+  frame::metrics::Add(frame::metrics::Counter::frames_painted, 1);
+  frame::metrics::Add(frame::metrics::Counter::frames_dropped, frame.dropped);
+
+  if (!has_frame_ || width_ != width || height_ != height) {
+    if (PaintFullFrame(buffer, width, height, stats)) {
+      tiles_.Reset(size);
+      tiles_.Update(buffer, size, {bounds});
+      stats.tiles_hashed = tiles_.tiles_hashed();
+      stats.tiles_changed = tiles_.tiles_changed();
+    }
+    return stats;
+  }
+
+  // Chromium often reports far more damage than actually changed
+  auto changed = tiles_.Update(buffer, size, frame.dirty);
+  stats.tiles_hashed = tiles_.tiles_hashed();
+  stats.tiles_changed = tiles_.tiles_changed();
+
+  auto plan = frame::PlanDamage(changed, size);
+  if (plan.full_frame) {
+    PaintFullFrame(buffer, width, height, stats);
+  } else if (!plan.rects.empty()) {
+    PaintRects(plan.rects, buffer, width, stats);
+  }
+  return stats;
+}
+
+// Popups are small and short-lived, so they are always sent whole
+void Painter::PaintPopup(const void* pixels, frame::Size size,
+                         const frame::Rect& rect) {
+  if (size.width == 0 || size.height == 0) {
+    HidePopup();
+    return;
+  }
+
+  // kitty places images at a cell and shifts them by less than a cell
+  auto window = tty::out::WindowSize();
+  auto cells = tty::out::WindowCells();
+  const int cell_width = std::max(1, window.width / std::max(1, cells.width));
+  const int cell_height =
+      std::max(1, window.height / std::max(1, cells.height));
+
+  Placement placement{{0, 0, size.width, size.height}, false, {}};
+  auto& display = placement.display;
+  display.image_id = kPopupImageId;
+  // the answer releases the popup's segment or file
+  display.acknowledge = true;
+  display.placement_id = kPopupPlacementId;
+  display.z_index = kPopupZIndex;
+  display.cell = {rect.x / cell_width, rect.y / cell_height};
+  display.offset = {rect.x % cell_width, rect.y % cell_height};
+  // rendered below the terminal's resolution, the nearest whole number of
+  // cells is as close as stretching gets
+  if (size.width != rect.width || size.height != rect.height) {
+    display.cells = {(rect.width + cell_width / 2) / cell_width,
+                     (rect.height + cell_height / 2) / cell_height};
+  }
+
+  // popups are not frames of the view and stay out of its stats
+  frame::FrameStats stats;
+  ReleaseAcknowledged();
+  BeginUpdate();
+  SendRect(pixels, size.width, placement, stats);
+  EndUpdate();
+}
+
+void Painter::HidePopup() {
+  BeginUpdate();
+  SendDelete(kPopupImageId);
+  EndUpdate();
+}
+
+void Painter::Repaint() { has_frame_ = false; }
+
+void Painter::DropImage() {
+  has_frame_ = false;
+  stale_image_ = true;
+}
+
+void Painter::DeleteImages() {
+  SendDelete(kViewImageId);
+  SendDelete(kPopupImageId);
+}
+
+void Painter::Flush() {
+  if (worker_) worker_->Flush();
+}
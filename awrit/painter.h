@@ -0,0 +1,130 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_PAINTER_H
+#define AWRIT_PAINTER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "frame/file_pool.h"
+#include "frame/mailbox.h"
+#include "frame/pacer.h"
+#include "frame/pixels.h"
+#include "frame/rect.h"
+#include "frame/shm_pool.h"
+#include "frame/stats.h"
+#include "frame/tile_index.h"
+#include "frame/worker.h"
+#include "transport.h"
+#include "tty/output.h"
+
+struct PainterOptions {
+  // edge length in pixels of the tiles used to skip unchanged regions
+  int tile_size = 64;
+  // back shared memory segments with transparent huge pages where possible
+  bool shm_huge_pages = false;
+  // how frames reach the terminal, already chosen
+  Transport transport = Transport::shm;
+  // told about every frame that asks the terminal for an acknowledgement
+  frame::FramePacer* pacer = nullptr;
+  // answers to every command that asked for one, counted by whoever reads
+  // them from the terminal. They release shm segments and files, so the
+  // shm and file transports need it.
+  const std::atomic<uint64_t>* answers = nullptr;
+};
+
+// Turns BGRA frames into graphics commands on tty::out, sending only what
+// changed since the previous frame. It does not depend on CEF or on a
+// terminal being attached, all of its work happens on the calling thread
+// except compressing direct frames. Not thread-safe.
+class Painter {
+ public:
+  // ids of the images the view and popups are displayed under
+  static constexpr uint32_t kViewImageId = 1;
+  static constexpr uint32_t kPopupImageId = 2;
+
+  explicit Painter(const PainterOptions& options);
+  ~Painter();
+
+  Painter(const Painter&) = delete;
+  Painter& operator=(const Painter&) = delete;
+
+  // Sends |frame|, or the parts of it that changed since the previous one
+  frame::FrameStats Paint(const frame::FrameMailbox::Frame& frame);
+
+  // Shows the popup of |size| BGRA |pixels| over the view, covering |rect| of
+  // the terminal's pixels
+  void PaintPopup(const void* pixels, frame::Size size,
+                  const frame::Rect& rect);
+  void HidePopup();
+
+  // The terminal lost the displayed image, the next frame is sent whole
+  void Repaint();
+  // The displayed image is no longer needed and is freed with the next frame
+  void DropImage();
+  // Frees every image in the terminal
+  void DeleteImages();
+
+  // Blocks until everything painted so far is queued for the tty
+  void Flush();
+
+ private:
+  // How a converted rect is handed to the terminal
+  struct Placement {
+    frame::Rect rect;
+    // edit the displayed image in place instead of replacing it
+    bool edit = false;
+    // the image the rect belongs to and where it goes, |display.acknowledge|
+    // is set for the last rect of a view frame and for popups
+    tty::out::Placement display;
+  };
+
+  const Transport transport_;
+  frame::FramePacer* const pacer_;
+  const std::atomic<uint64_t>* const answers_;
+  // answers already passed on to the pools
+  uint64_t acknowledged_ = 0;
+  std::unique_ptr<frame::ShmPool> pool_;
+  std::unique_ptr<frame::FilePool> files_;
+  // compresses and writes direct frames off the painting thread
+  std::unique_ptr<frame::Worker> worker_;
+  // only touched by |worker_|
+  std::string compressed_;
+  int width_ = 0;
+  int height_ = 0;
+  // the terminal holds a complete frame that rects can be applied to
+  bool has_frame_ = false;
+  // the last conversion found a translucent pixel
+  bool translucent_ = false;
+  // the displayed image goes with the next full frame
+  bool stale_image_ = false;
+  // hashes of the frame held by the terminal
+  frame::TileIndex tiles_;
+  uint64_t frames_ = 0;
+
+  frame::PixelFormat ConvertRect(const void* buffer, int width,
+                                 const frame::Rect& rect, void* dest);
+  bool SendDirect(const void* buffer, int width, const Placement& placement,
+                  frame::FrameStats& stats);
+  bool SendShm(const void* buffer, int width, const Placement& placement,
+               frame::FrameStats& stats);
+  bool SendFile(const void* buffer, int width, const Placement& placement,
+                frame::FrameStats& stats);
+  void ReleaseAcknowledged();
+  bool SendRect(const void* buffer, int width, const Placement& placement,
+                frame::FrameStats& stats);
+  void BeginUpdate();
+  void EndUpdate();
+  void SendDelete(uint32_t image_id);
+  bool PaintFullFrame(const void* buffer, int width, int height,
+                      frame::FrameStats& stats);
+  bool PaintRects(const std::vector<frame::Rect>& rects, const void* buffer,
+                  int width, frame::FrameStats& stats);
+};
+
+#endif  // AWRIT_PAINTER_H
@@ -0,0 +1,127 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "painter.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "tty/escape_codes.h"
+
+namespace {
+// Captures the graphics commands of a test in place of a terminal
+class PainterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    fflush(stdout);
+    stdout_ = dup(STDOUT_FILENO);
+    capture_ = tmpfile();
+    ASSERT_NE(capture_, nullptr);
+    dup2(fileno(capture_), STDOUT_FILENO);
+  }
+
+  void TearDown() override {
+    tty::out::Flush();
+    fflush(stdout);
+    dup2(stdout_, STDOUT_FILENO);
+    close(stdout_);
+    fclose(capture_);
+  }
+
+  // The commands sent so far that ask the terminal for an answer
+  uint64_t Requests() {
+    tty::out::Flush();
+    fflush(stdout);
+    std::string output;
+    rewind(capture_);
+    char buffer[4096];
+    size_t read;
+    while ((read = fread(buffer, 1, sizeof(buffer), capture_)) > 0) {
+      output.append(buffer, read);
+    }
+    fseek(capture_, 0, SEEK_END);
+
+    uint64_t requests = 0;
+    size_t start = 0;
+    while ((start = output.find(ESC "_G", start)) != std::string::npos) {
+      size_t end = output.find_first_of(";" ESC, start + 3);
+      std::string keys = output.substr(start + 3, end - start - 3);
+      if (keys.find("i=") != std::string::npos &&
+          keys.find("q=2") == std::string::npos) {
+        ++requests;
+      }
+      start = end;
+    }
+    return requests;
+  }
+
+  static frame::FrameMailbox::Frame MakeFrame(frame::Size size) {
+    frame::FrameMailbox::Frame frame;
+    frame.size = size;
+    frame.pixels.assign(size.width * size.height * 4, 0xff);
+    frame.dirty = {{0, 0, size.width, size.height}};
+    frame.posted = std::chrono::steady_clock::now();
+    return frame;
+  }
+
+ private:
+  int stdout_ = -1;
+  FILE* capture_ = nullptr;
+};
+}  // namespace
+
+TEST_F(PainterTest, PopupsDoNotStarveTheView) {
+  frame::FramePacer pacer;
+  std::atomic<uint64_t> answers{0};
+  PainterOptions options;
+  options.transport = Transport::shm;
+  options.pacer = &pacer;
+  options.answers = &answers;
+  Painter painter(options);
+
+  // hovering the options of a <select> while the view is idle, more popups
+  // than the pool has segments, the terminal answers what asks for it
+  std::vector<uint8_t> popup(16 * 16 * 4, 0xff);
+  for (int i = 0; i < 40; ++i) {
+    painter.PaintPopup(popup.data(), {16, 16}, {0, 0, 16, 16});
+    answers = Requests();
+  }
+
+  auto stats = painter.Paint(MakeFrame({64, 64}));
+  EXPECT_TRUE(stats.full_frame);
+  EXPECT_EQ(stats.rects, 1u);
+}
+
+TEST_F(PainterTest, KeepsPaintingForSilentTerminals) {
+  frame::FramePacer pacer(1, std::chrono::milliseconds(1));
+  std::atomic<uint64_t> answers{0};
+  for (auto transport : {Transport::shm, Transport::file}) {
+    PainterOptions options;
+    options.transport = transport;
+    options.pacer = &pacer;
+    options.answers = &answers;
+    Painter painter(options);
+
+    // more frames than the pools hold, well within their own timeout, and
+    // not a single answer
+    auto frame = MakeFrame({64, 64});
+    int painted = 0;
+    for (int i = 0; i < 40; ++i) {
+      painter.Repaint();
+      painted += painter.Paint(frame).rects;
+      // the UI thread asks before every frame
+      std::this_thread::sleep_for(std::chrono::milliseconds(2));
+      pacer.Ready();
+    }
+    EXPECT_FALSE(pacer.pacing());
+    EXPECT_EQ(painted, 40);
+  }
+}
@@ -0,0 +1,156 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "base64.h"
+
+#include <cstdint>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AWRIT_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace simd {
+
+namespace {
+
+// Kernels return the number of characters written to |dest|
+using EncodeKernel = size_t (*)(char* dest, const uint8_t* src, size_t len);
+
+constexpr char kAlphabet[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+size_t EncodeScalar(char* dest, const uint8_t* src, size_t len) {
+  char* out = dest;
+  size_t i = 0;
+  for (; i + 3 <= len; i += 3, out += 4) {
+    uint32_t triple = src[i] << 16 | src[i + 1] << 8 | src[i + 2];
+    out[0] = kAlphabet[triple >> 18];
+    out[1] = kAlphabet[(triple >> 12) & 0x3f];
+    out[2] = kAlphabet[(triple >> 6) & 0x3f];
+    out[3] = kAlphabet[triple & 0x3f];
+  }
+  if (i < len) {
+    uint32_t triple = src[i] << 16;
+    if (i + 1 < len) triple |= src[i + 1] << 8;
+    out[0] = kAlphabet[triple >> 18];
+    out[1] = kAlphabet[(triple >> 12) & 0x3f];
+    out[2] = i + 1 < len ? kAlphabet[(triple >> 6) & 0x3f] : '=';
+    out[3] = '=';
+    out += 4;
+  }
+  return out - dest;
+}
+
+#if defined(AWRIT_X86_DISPATCH)
+// The vector kernels follow Muła and Lemire, "Faster Base64 Encoding and
+// Decoding using AVX2 Instructions": each 12 byte group is spread so that every
+// 32 bit lane holds 3 bytes, the four 6 bit indices are moved into their own
+// bytes with two multiplies, and the indices are turned into characters by
+// adding an offset looked up per alphabet range.
+
+__attribute__((target("ssse3"))) __m128i SpreadIndices(__m128i in) {
+  in = _mm_shuffle_epi8(
+      in, _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+  const __m128i ac =
+      _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+                      _mm_set1_epi32(0x04000040));
+  const __m128i bd =
+      _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+                      _mm_set1_epi32(0x01000010));
+  return _mm_or_si128(ac, bd);
+}
+
+__attribute__((target("ssse3"))) __m128i IndicesToASCII(__m128i indices) {
+  // 0 for a-z, 1-10 for 0-9, 11 for +, 12 for / and 13 for A-Z
+  __m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+  const __m128i upper = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+  range = _mm_or_si128(range, _mm_and_si128(upper, _mm_set1_epi8(13)));
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+  return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+}
+
+__attribute__((target("ssse3"))) size_t EncodeSSSE3(char* dest,
+                                                    const uint8_t* src,
+                                                    size_t len) {
+  size_t i = 0;
+  char* out = dest;
+  // loads 16 bytes to encode 12
+  for (; i + 16 <= len; i += 12, out += 16) {
+    __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+                     IndicesToASCII(SpreadIndices(in)));
+  }
+  return (out - dest) + EncodeScalar(out, src + i, len - i);
+}
+
+__attribute__((target("avx2"))) size_t EncodeAVX2(char* dest,
+                                                  const uint8_t* src,
+                                                  size_t len) {
+  const __m256i spread = _mm256_setr_epi8(
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10,  //
+      1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  const __m256i offsets = _mm256_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+  size_t i = 0;
+  char* out = dest;
+  // each lane loads 16 bytes to encode 12, the second lane starting 12 bytes in
+  for (; i + 28 <= len; i += 24, out += 32) {
+    __m256i in = _mm256_inserti128_si256(
+        _mm256_castsi128_si256(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 12)), 1);
+    in = _mm256_shuffle_epi8(in, spread);
+    const __m256i ac =
+        _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+                           _mm256_set1_epi32(0x04000040));
+    const __m256i bd =
+        _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+                           _mm256_set1_epi32(0x01000010));
+    const __m256i indices = _mm256_or_si256(ac, bd);
+
+    __m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+    const __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+    range = _mm256_or_si256(range,
+                            _mm256_and_si256(upper, _mm256_set1_epi8(13)));
+    _mm256_storeu_si256(
+        reinterpret_cast<__m256i*>(out),
+        _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices));
+  }
+  return (out - dest) + EncodeSSSE3(out, src + i, len - i);
+}
+#endif
+
+EncodeKernel GetEncodeKernel(Kernel kernel) {
+  switch (kernel) {
+#if defined(AWRIT_X86_DISPATCH)
+    case Kernel::SSSE3:
+      return EncodeSSSE3;
+    case Kernel::AVX2:
+      return EncodeAVX2;
+#endif
+    default:
+      return EncodeScalar;
+  }
+}
+
+}  // namespace
+
+size_t Base64Encode(char* dest, const char* src, size_t len) {
+  static const EncodeKernel kernel = GetEncodeKernel(BestKernel());
+  return kernel(dest, reinterpret_cast<const uint8_t*>(src), len);
+}
+
+size_t Base64Encode(char* dest, const char* src, size_t len, Kernel kernel) {
+  return GetEncodeKernel(kernel)(dest, reinterpret_cast<const uint8_t*>(src),
+                                 len);
+}
+
+}  // namespace simd
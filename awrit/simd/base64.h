@@ -0,0 +1,29 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_SIMD_BASE64_H
+#define AWRIT_SIMD_BASE64_H
+
+#include <cstddef>
+
+#include "kernel.h"
+
+namespace simd {
+
+// Number of characters Base64Encode writes for |len| bytes, the same as
+// modp_b64_encode_data_len
+constexpr size_t Base64EncodedSize(size_t len) { return (len + 2) / 3 * 4; }
+
+// Encodes |len| bytes at |src| as padded standard base64 into |dest|, which
+// must hold Base64EncodedSize(len) characters and is not null terminated.
+// Returns the number of characters written. Produces the same output as
+// modp_b64_encode_data, using the best kernel for the running CPU.
+size_t Base64Encode(char* dest, const char* src, size_t len);
+// Same as above with a specific |kernel|, SSE2 alone has no vector encoder and
+// falls back to the scalar one
+size_t Base64Encode(char* dest, const char* src, size_t len, Kernel kernel);
+
+}  // namespace simd
+
+#endif  // AWRIT_SIMD_BASE64_H
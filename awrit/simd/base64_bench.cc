@@ -0,0 +1,58 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+// Measures the throughput of each base64 kernel against modp_b64 on inputs
+// from 1 to 64 MiB:
+//   base64_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+#include "base64.h"
+#include "third_party/modp_b64.h"
+
+namespace {
+
+void Measure(const char* name, size_t bytes, int iterations,
+             const std::function<size_t()>& encode) {
+  encode();
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i) encode();
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  double per_call_ms = elapsed.count() * 1000 / iterations;
+  double gib_per_s =
+      bytes * static_cast<double>(iterations) / elapsed.count() / (1 << 30);
+  printf("%-8s %8.3f ms %8.2f GiB/s read\n", name, per_call_ms, gib_per_s);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  const int iterations = argc > 1 ? atoi(argv[1]) : 20;
+
+  for (size_t mib = 1; mib <= 64; mib *= 4) {
+    const size_t bytes = mib << 20;
+    std::vector<char> src(bytes);
+    for (size_t i = 0; i < src.size(); ++i) src[i] = static_cast<char>(i * 31);
+    std::vector<char> dest(simd::Base64EncodedSize(bytes));
+
+    printf("%zu MiB, %d iterations\n", mib, iterations);
+    Measure("modp", bytes, iterations, [&] {
+      return modp_b64_encode_data(dest.data(), src.data(), bytes);
+    });
+    for (auto kernel : {simd::Kernel::Scalar, simd::Kernel::SSSE3,
+                        simd::Kernel::AVX2}) {
+      if (!simd::IsSupported(kernel)) continue;
+      Measure(simd::KernelName(kernel), bytes, iterations, [&] {
+        return simd::Base64Encode(dest.data(), src.data(), bytes, kernel);
+      });
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,83 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "base64.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+
+#include "third_party/modp_b64.h"
+
+using namespace simd;
+
+namespace {
+std::string RandomBytes(size_t len) {
+  std::mt19937 engine(42);
+  std::uniform_int_distribution<int> dist(0, 255);
+  std::string result(len, '\0');
+  for (auto& byte : result) byte = static_cast<char>(dist(engine));
+  return result;
+}
+
+std::string Encode(const std::string& src, Kernel kernel) {
+  std::string encoded(Base64EncodedSize(src.size()), '\0');
+  encoded.resize(Base64Encode(encoded.data(), src.data(), src.size(), kernel));
+  return encoded;
+}
+
+std::string EncodeModp(const std::string& src) {
+  std::string encoded(modp_b64_encode_data_len(src.size()), '\0');
+  encoded.resize(modp_b64_encode_data(encoded.data(), src.data(), src.size()));
+  return encoded;
+}
+}  // namespace
+
+TEST(Base64Test, Padding) {
+  EXPECT_EQ(Encode("", Kernel::Scalar), "");
+  EXPECT_EQ(Encode("f", Kernel::Scalar), "Zg==");
+  EXPECT_EQ(Encode("fo", Kernel::Scalar), "Zm8=");
+  EXPECT_EQ(Encode("foo", Kernel::Scalar), "Zm9v");
+  EXPECT_EQ(Encode("/awrit-1", Kernel::Scalar), "L2F3cml0LTE=");
+}
+
+TEST(Base64Test, KernelsMatchModp) {
+  // every length up to a few vector iterations plus each possible tail
+  const std::string bytes = RandomBytes(1 << 16);
+  for (auto kernel :
+       {Kernel::Scalar, Kernel::SSE2, Kernel::SSSE3, Kernel::AVX2}) {
+    if (!IsSupported(kernel)) continue;
+    SCOPED_TRACE(KernelName(kernel));
+    for (size_t len = 0; len < 200; ++len) {
+      auto src = bytes.substr(len, len);
+      ASSERT_EQ(Encode(src, kernel), EncodeModp(src)) << "length " << len;
+    }
+    EXPECT_EQ(Encode(bytes, kernel), EncodeModp(bytes));
+  }
+}
+
+TEST(Base64Test, EveryIndex) {
+  // covers each character of the alphabet in every position of a group
+  std::string src;
+  for (int i = 0; i < 64 * 3; ++i) {
+    int index = i / 3;
+    src += static_cast<char>(index << 2 | index >> 4);
+    src += static_cast<char>(index << 4 | index >> 2);
+    src += static_cast<char>(index << 6 | index);
+  }
+  for (auto kernel :
+       {Kernel::Scalar, Kernel::SSE2, Kernel::SSSE3, Kernel::AVX2}) {
+    if (!IsSupported(kernel)) continue;
+    SCOPED_TRACE(KernelName(kernel));
+    EXPECT_EQ(Encode(src, kernel), EncodeModp(src));
+  }
+}
+
+TEST(Base64Test, BestKernel) {
+  const std::string src = RandomBytes(1000);
+  std::string encoded(Base64EncodedSize(src.size()), '\0');
+  encoded.resize(Base64Encode(encoded.data(), src.data(), src.size()));
+  EXPECT_EQ(encoded, EncodeModp(src));
+}
@@ -0,0 +1,51 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "kernel.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AWRIT_X86_DISPATCH 1
+#endif
+
+namespace simd {
+
+bool IsSupported(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::Scalar:
+      return true;
+#if defined(AWRIT_X86_DISPATCH)
+    case Kernel::SSE2:
+      return __builtin_cpu_supports("sse2");
+    case Kernel::SSSE3:
+      return __builtin_cpu_supports("ssse3");
+    case Kernel::AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+Kernel BestKernel() {
+  if (IsSupported(Kernel::AVX2)) return Kernel::AVX2;
+  if (IsSupported(Kernel::SSSE3)) return Kernel::SSSE3;
+  if (IsSupported(Kernel::SSE2)) return Kernel::SSE2;
+  return Kernel::Scalar;
+}
+
+const char* KernelName(Kernel kernel) {
+  switch (kernel) {
+    case Kernel::Scalar:
+      return "scalar";
+    case Kernel::SSE2:
+      return "sse2";
+    case Kernel::SSSE3:
+      return "ssse3";
+    case Kernel::AVX2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+}  // namespace simd
@@ -0,0 +1,20 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_SIMD_KERNEL_H
+#define AWRIT_SIMD_KERNEL_H
+
+namespace simd {
+
+// Instruction sets a kernel can be written for
+enum class Kernel { Scalar, SSE2, SSSE3, AVX2 };
+
+// Fastest kernel supported by the running CPU
+Kernel BestKernel();
+const char* KernelName(Kernel kernel);
+bool IsSupported(Kernel kernel);
+
+}  // namespace simd
+
+#endif  // AWRIT_SIMD_KERNEL_H
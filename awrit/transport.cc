@@ -0,0 +1,200 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "transport.h"
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#include "frame/file_pool.h"
+#include "frame/shm_pool.h"
+#include "string/string_utils.h"
+#include "tty/graphics.h"
+#include "tty/input.h"
+#include "tty/output.h"
+
+namespace {
+
+// ids of the query replies, queries are not stored so they cannot clash with
+// the ids of displayed images
+constexpr uint32_t kShmQueryId = 31;
+constexpr uint32_t kFileQueryId = 32;
+constexpr uint32_t kDirectQueryId = 33;
+
+std::string CacheKey() {
+  const char* term = getenv("TERM");
+  const char* window = getenv("KITTY_WINDOW_ID");
+  return std::string("term=") + (term ? term : "") +
+         " window=" + (window ? window : "");
+}
+
+// Lines of the cache look like:
+// term=xterm-kitty window=1 shm=1 file=1 direct=1 sync=1
+// lines written before sync= was probed are probed again
+std::optional<GraphicsSupport> ReadCache(const std::string& path,
+                                         const std::string& key) {
+  std::ifstream file(path);
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.size() <= key.size() || line.compare(0, key.size(), key) != 0 ||
+        line[key.size()] != ' ') {
+      continue;
+    }
+
+    GraphicsSupport support;
+    bool probed_sync = false;
+    std::string_view fields(line);
+    fields.remove_prefix(key.size() + 1);
+    for (auto field : string::split(fields, ' ')) {
+      if (field == "shm=1") support.shm = true;
+      if (field == "file=1") support.file = true;
+      if (field == "direct=1") support.direct = true;
+      if (field.substr(0, 5) == "sync=") {
+        probed_sync = true;
+        support.synchronized = field == "sync=1";
+      }
+    }
+    if (!probed_sync) return {};
+    return support;
+  }
+  return {};
+}
+
+void WriteCache(const std::string& path, const std::string& key,
+                const GraphicsSupport& support) {
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+      if (line.compare(0, key.size() + 1, key + " ") != 0)
+        lines.push_back(line);
+    }
+  }
+
+  size_t slash = path.rfind('/');
+  if (slash != std::string::npos) mkdir(path.substr(0, slash).c_str(), 0700);
+
+  // replaced in one go so that concurrent starts never see half a file
+  std::string temp = path + "." + std::to_string(getpid());
+  {
+    std::ofstream file(temp, std::ios::trunc);
+    for (const auto& line : lines) file << line << '\n';
+    file << key << " shm=" << support.shm << " file=" << support.file
+         << " direct=" << support.direct << " sync=" << support.synchronized
+         << '\n';
+    if (!file) {
+      unlink(temp.c_str());
+      return;
+    }
+  }
+  rename(temp.c_str(), path.c_str());
+}
+
+std::optional<GraphicsSupport> QueryTerminal(int timeout_ms) {
+  static constexpr char kPixel[3] = {};
+
+  // the pools unlink their files once they go out of scope, after the replies
+  frame::ShmPool pool;
+  if (auto* segment = pool.Acquire(sizeof(kPixel))) {
+    memcpy(segment->data, kPixel, sizeof(kPixel));
+    tty::out::QueryBitmap(
+        SourceFor(*segment, sizeof(kPixel), frame::PixelFormat::RGB),
+        kShmQueryId);
+  }
+
+  frame::FilePool files;
+  if (auto* file = files.Acquire(sizeof(kPixel))) {
+    memcpy(file->data, kPixel, sizeof(kPixel));
+    tty::out::QueryBitmap(
+        SourceFor(*file, sizeof(kPixel), frame::PixelFormat::RGB),
+        kFileQueryId);
+  }
+
+  tty::out::QueryBitmap({{kPixel, sizeof(kPixel)},
+                         tty::out::NameType::direct,
+                         tty::out::Format::rgb},
+                        kDirectQueryId);
+  tty::out::RequestMode(tty::out::pending_update);
+  tty::out::RequestDeviceAttributes();
+
+  tty::graphics::QueryParser parser;
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+  while (!parser.done()) {
+    auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    deadline - std::chrono::steady_clock::now())
+                    .count();
+    if (left <= 0) break;
+    auto wait = tty::in::WaitForReady(left);
+    if (wait == tty::in::Wait::error) break;
+    if (wait != tty::in::Wait::ready) continue;
+
+    auto input = tty::in::Read();
+    if (input.empty()) break;
+    parser.Parse(input);
+  }
+  // keys typed while waiting reach the page once awrit listens to input
+  tty::in::Unread(parser.input());
+
+  if (!parser.done()) return {};
+
+  GraphicsSupport support;
+  for (const auto& reply : parser.replies()) {
+    if (reply.image_id == kShmQueryId) support.shm = reply.ok;
+    if (reply.image_id == kFileQueryId) support.file = reply.ok;
+    if (reply.image_id == kDirectQueryId) support.direct = reply.ok;
+  }
+  for (const auto& report : parser.modes()) {
+    if (report.mode == tty::out::pending_update)
+      support.synchronized = report.supported();
+  }
+  return support;
+}
+
+}  // namespace
+
+tty::out::Source SourceFor(const frame::ShmSegment& segment, size_t size,
+                           frame::PixelFormat format) {
+  auto bits = static_cast<tty::out::Format>(format);
+  if (!segment.path.empty())
+    return {segment.path, tty::out::NameType::regular_file, bits, size};
+  return {segment.name, tty::out::NameType::shm, bits, size};
+}
+
+tty::out::Source SourceFor(const frame::FrameFile& file, size_t size,
+                           frame::PixelFormat format) {
+  return {file.path, tty::out::NameType::regular_file,
+          static_cast<tty::out::Format>(format), size};
+}
+
+std::optional<GraphicsSupport> ProbeGraphics(const std::string& cache_path,
+                                             int timeout_ms) {
+  const std::string key = CacheKey();
+  if (!cache_path.empty()) {
+    if (auto support = ReadCache(cache_path, key)) return support;
+  }
+
+  auto support = QueryTerminal(timeout_ms);
+  if (support && !cache_path.empty()) WriteCache(cache_path, key, *support);
+  return support;
+}
+
+Transport ChooseTransport(const std::optional<GraphicsSupport>& support) {
+  if (support) {
+    if (support->shm) return Transport::shm;
+    if (support->file) return Transport::file;
+    if (support->direct) return Transport::direct;
+  } else if (getenv("SSH_CONNECTION") || getenv("SSH_TTY")) {
+    return Transport::direct;
+  }
+  return Transport::shm;
+}
@@ -0,0 +1,67 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_TRANSPORT_H
+#define AWRIT_TRANSPORT_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+#include "frame/pixels.h"
+
+namespace frame {
+struct FrameFile;
+struct ShmSegment;
+}
+namespace tty::out {
+struct Source;
+}
+
+// How frames reach the terminal
+enum class Transport {
+  // probe the terminal and pick the cheapest transport it accepts
+  automatic,
+  // the terminal reads frames from shared memory, needs it to run locally
+  shm,
+  // the terminal reads frames from files, for sandboxes that hide our shm
+  file,
+  // frames are compressed and written to the tty itself, works over SSH
+  direct,
+};
+
+// The ways of handing pixel data over that the terminal accepted, and how
+// frames can be batched
+struct GraphicsSupport {
+  // shared memory segments, handed over the way the shm transport does
+  bool shm = false;
+  // regular files, handed over the way the file transport does
+  bool file = false;
+  // pixel data written to the tty
+  bool direct = false;
+  // synchronized updates, DEC private mode 2026
+  bool synchronized = false;
+};
+
+// Describes the first |size| bytes of |segment| to the terminal
+tty::out::Source SourceFor(const frame::ShmSegment& segment, size_t size,
+                           frame::PixelFormat format);
+tty::out::Source SourceFor(const frame::FrameFile& file, size_t size,
+                           frame::PixelFormat format);
+
+// Queries the terminal with a 1x1 image over every transport, asks for
+// synchronized update support and waits up to
+// |timeout_ms| for the replies, the tty must already be in raw mode. Answers
+// are cached in |cache_path| per $TERM and $KITTY_WINDOW_ID, so later starts
+// in the same terminal skip the round-trip. Keys typed in the meantime are
+// handed back to tty::in for the input thread. Returns nothing if the
+// terminal did not answer in time.
+std::optional<GraphicsSupport> ProbeGraphics(const std::string& cache_path,
+                                             int timeout_ms = 1000);
+
+// Picks the cheapest transport in |support|. Without an answer, direct is
+// assumed over SSH and shm everywhere else.
+Transport ChooseTransport(const std::optional<GraphicsSupport>& support);
+
+#endif  // AWRIT_TRANSPORT_H
@@ -19,5 +19,6 @@
 #define DECSACE_DEFAULT_REGION_SELECT CSI "*x"
 #define CLEAR_SCREEN CSI "H" CSI "2J"
 #define RESET_IRM CSI "4l"
+#define PRIMARY_DEVICE_ATTRIBUTES CSI "c"
 
 #endif  // AWRIT_TTY_ESCAPE_CODES_H
@@ -4,9 +4,29 @@
 
 #include "escape_parser.h"
 
+#include <algorithm>
+
 namespace tty {
 
 namespace {
+// CSI sequences around pasted text, given bracketed paste
+constexpr std::string_view kPasteStart = "200~";
+constexpr std::string_view kPasteEnd = "\x1b[201~";
+
+// The length of |text| without an incomplete UTF-8 sequence at its end
+size_t CompleteUTF8(std::string_view text) {
+  size_t start = text.size();
+  // back to the lead byte of the last sequence
+  while (start > 0 && text.size() - start < 4 &&
+         (static_cast<uint8_t>(text[start - 1]) & 0xc0) == 0x80) {
+    --start;
+  }
+  if (start == 0) return text.size();
+  uint8_t lead = text[start - 1];
+  size_t length = lead < 0x80 ? 1 : lead < 0xe0 ? 2 : lead < 0xf0 ? 3 : 4;
+  return start - 1 + length > text.size() ? start - 1 : text.size();
+}
+
 csi::Char csi_type(char ch) {
   if ((0x30 <= ch && ch <= 0x3f) || ch == '-') {
     return csi::Char::Parameter;
@@ -67,18 +87,80 @@ bool EscapeCodeParser::Parse(char ch) {
     case State::ESC_ST:
     case State::C1_ST:
       if (!Byte(ch)) return false;
+      break;
+
+    case State::Paste:
+      Paste({&ch, 1});
+      break;
   }
 
   return true;
 }
 
 bool EscapeCodeParser::Parse(std::string_view buffer) {
-  for (char ch : buffer) {
-    if (!Parse(ch)) return false;
+  while (!buffer.empty()) {
+    // pasted text is taken in bulk rather than a byte at a time
+    if (state_ == State::Paste) {
+      buffer = Paste(buffer);
+      continue;
+    }
+    if (!Parse(buffer.front())) return false;
+    buffer.remove_prefix(1);
   }
   return true;
 }
 
+std::string_view EscapeCodeParser::Paste(std::string_view buffer) {
+  while (!buffer.empty()) {
+    if (paste_matched_ == 0) {
+      auto esc = buffer.find('\x1b');
+      AppendPaste(buffer.substr(0, esc));
+      if (esc == std::string_view::npos) return {};
+      buffer.remove_prefix(esc + 1);
+      paste_matched_ = 1;
+      continue;
+    }
+
+    if (buffer.front() != kPasteEnd[paste_matched_]) {
+      // not the end after all, what matched so far was pasted
+      AppendPaste(kPasteEnd.substr(0, paste_matched_));
+      paste_matched_ = 0;
+      continue;
+    }
+    buffer.remove_prefix(1);
+    if (++paste_matched_ == kPasteEnd.size()) {
+      FlushPaste(true);
+      paste_bytes_ = 0;
+      paste_matched_ = 0;
+      state_ = State::Normal;
+      return buffer;
+    }
+  }
+  return buffer;
+}
+
+void EscapeCodeParser::AppendPaste(std::string_view text) {
+  if (paste_bytes_ >= kMaxPasteBytes) return;
+  text = text.substr(0, kMaxPasteBytes - paste_bytes_);
+  paste_bytes_ += text.size();
+  while (!text.empty()) {
+    size_t size = std::min(text.size(), kPasteChunkBytes - paste_.size());
+    paste_ += text.substr(0, size);
+    text.remove_prefix(size);
+    if (paste_.size() >= kPasteChunkBytes) FlushPaste(false);
+  }
+}
+
+void EscapeCodeParser::FlushPaste(bool last) {
+  size_t size = last ? paste_.size() : CompleteUTF8(paste_);
+  // a carriage return may be the start of a CRLF, which has to stay whole to
+  // become a single line break
+  if (!last && size && paste_[size - 1] == '\r') --size;
+  HandlePaste({paste_.data(), size}, last);
+  paste_.erase(0, size);
+  if (last) paste_.clear();
+}
+
 bool EscapeCodeParser::UTF8Codepoint(uint32_t ch) {
   switch (ch) {
     case 0x1b:
@@ -132,6 +214,7 @@ bool EscapeCodeParser::Byte(uint8_t ch) {
     case State::C1_ST:
       return C1_ST(ch);
     case State::Normal:
+    case State::Paste:
       return true;
     default:
       unreachable();
@@ -242,6 +325,11 @@ bool EscapeCodeParser::EscapeCode() {
   bool result = true;
   switch (handler_) {
     case Handler::CSI:
+      if (buffer_ == kPasteStart) {
+        Reset();
+        state_ = State::Paste;
+        return true;
+      }
       result = HandleCSI(buffer_);
       break;
     case Handler::OSC:
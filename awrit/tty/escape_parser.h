@@ -24,6 +24,11 @@ class EscapeCodeParser {
 
   bool Parse(std::string_view buffer);
 
+  // pasted text is handed over in pieces of up to this size
+  static constexpr size_t kPasteChunkBytes = 64 * 1024;
+  // pasted text beyond this is dropped
+  static constexpr size_t kMaxPasteBytes = 16 * 1024 * 1024;
+
  protected:
   virtual bool HandleUTF8Codepoint(uint32_t) { return true; };
   virtual bool HandleCSI(const std::string&) { return true; };
@@ -32,6 +37,10 @@ class EscapeCodeParser {
   virtual bool HandlePM(const std::string&) { return true; };
   virtual bool HandleSOS(const std::string&) { return true; };
   virtual bool HandleAPC(const std::string&) { return true; };
+  // Text pasted between the bracketed paste markers, in pieces that end on
+  // whole UTF-8 sequences and never between a CR and its LF, |last| is set on
+  // the final one
+  virtual void HandlePaste(std::string_view, bool /* last */) {}
 
  private:
   enum class State {
@@ -42,6 +51,7 @@ class EscapeCodeParser {
     ST_or_BEL,
     ESC_ST,
     C1_ST,
+    Paste,
   };
 
   enum class Handler {
@@ -60,6 +70,11 @@ class EscapeCodeParser {
   csi::State csi_state_;
   std::string buffer_;
   Handler handler_;
+  // the pasted text not handed over yet
+  std::string paste_;
+  size_t paste_bytes_ = 0;
+  // bytes of the end marker seen so far
+  size_t paste_matched_ = 0;
 
   bool Parse(char ch);
   bool Reset();
@@ -74,6 +89,11 @@ class EscapeCodeParser {
   bool ST(uint8_t ch);
   bool ESC_ST(uint8_t ch);
   bool C1_ST(uint8_t ch);
+
+  // Takes pasted text up to the end marker, returns what follows it
+  std::string_view Paste(std::string_view buffer);
+  void AppendPaste(std::string_view text);
+  void FlushPaste(bool last);
 };
 
 }  // namespace tty
@@ -38,3 +38,94 @@ TEST(EscapeParserTest, MouseMove) {
   TestParser parser;
   parser.Parse(input);
 }
+
+namespace {
+class PasteParser : public tty::EscapeCodeParser {
+ public:
+  std::vector<std::string> pieces;
+  std::vector<std::string> csi;
+  int done = 0;
+
+ protected:
+  bool HandleCSI(const std::string &str) override {
+    csi.push_back(str);
+    return true;
+  }
+  void HandlePaste(std::string_view text, bool last) override {
+    pieces.emplace_back(text);
+    if (last) ++done;
+  }
+};
+}  // namespace
+
+TEST(EscapeParserTest, BracketedPaste) {
+  PasteParser parser;
+  parser.Parse(CSI "200~hello\x1b[A world\r" CSI "201~" CSI "D");
+  ASSERT_EQ(parser.done, 1);
+  ASSERT_EQ(parser.pieces.size(), 1u);
+  EXPECT_EQ(parser.pieces[0], "hello\x1b[A world\r");
+  // only what follows the paste is parsed
+  ASSERT_EQ(parser.csi.size(), 1u);
+  EXPECT_EQ(parser.csi[0], "D");
+}
+
+TEST(EscapeParserTest, BracketedPasteAcrossReads) {
+  PasteParser parser;
+  std::string input = CSI "200~abc" CSI "201~";
+  for (char ch : input) parser.Parse(std::string_view(&ch, 1));
+  ASSERT_EQ(parser.done, 1);
+  std::string pasted;
+  for (const auto &piece : parser.pieces) pasted += piece;
+  EXPECT_EQ(pasted, "abc");
+  EXPECT_TRUE(parser.csi.empty());
+}
+
+TEST(EscapeParserTest, LargePasteIsStreamedOnWholeCharacters) {
+  PasteParser parser;
+  // three byte characters never line up with the chunk size
+  std::string text;
+  while (text.size() < 3 * tty::EscapeCodeParser::kPasteChunkBytes) {
+    text += "\xe2\x82\xac";
+  }
+  parser.Parse(CSI "200~");
+  parser.Parse(text);
+  parser.Parse(CSI "201~");
+  ASSERT_EQ(parser.done, 1);
+  EXPECT_GT(parser.pieces.size(), 2u);
+  std::string pasted;
+  for (const auto &piece : parser.pieces) {
+    EXPECT_EQ(piece.size() % 3, 0u);
+    EXPECT_LE(piece.size(), tty::EscapeCodeParser::kPasteChunkBytes + 3);
+    pasted += piece;
+  }
+  EXPECT_EQ(pasted, text);
+}
+
+TEST(EscapeParserTest, LargePasteKeepsCRLFTogether) {
+  PasteParser parser;
+  // the CRLF straddles the end of the first piece
+  std::string text(tty::EscapeCodeParser::kPasteChunkBytes - 1, 'a');
+  text += "\r\nb";
+  parser.Parse(CSI "200~");
+  parser.Parse(text);
+  parser.Parse(CSI "201~");
+  ASSERT_EQ(parser.done, 1);
+  ASSERT_EQ(parser.pieces.size(), 2u);
+  EXPECT_EQ(parser.pieces[0].back(), 'a');
+  EXPECT_EQ(parser.pieces[1], "\r\nb");
+}
+
+TEST(EscapeParserTest, PasteIsCapped) {
+  PasteParser parser;
+  std::string chunk(1024 * 1024, 'x');
+  parser.Parse(CSI "200~");
+  for (size_t sent = 0; sent <= tty::EscapeCodeParser::kMaxPasteBytes;
+       sent += chunk.size()) {
+    parser.Parse(chunk);
+  }
+  parser.Parse(CSI "201~" CSI "D");
+  size_t pasted = 0;
+  for (const auto &piece : parser.pieces) pasted += piece.size();
+  EXPECT_EQ(pasted, tty::EscapeCodeParser::kMaxPasteBytes);
+  ASSERT_EQ(parser.csi.size(), 1u);
+}
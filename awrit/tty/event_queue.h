@@ -0,0 +1,97 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_TTY_EVENT_QUEUE_H
+#define AWRIT_TTY_EVENT_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <utility>
+
+namespace tty {
+
+// A ring of up to |Capacity| events, pushed from one thread and popped from
+// another without locking.
+//
+// The producer pushes a batch and then calls ScheduleDrain, which is true only
+// for the first batch since the consumer last started draining, so a burst of
+// input costs a single wakeup of the consumer. A producer that finds the ring
+// full waits in WaitForRoom, which only costs the consumer anything while
+// someone is waiting.
+template <typename T, size_t Capacity>
+class EventQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0,
+                "Capacity must be a power of two");
+
+ public:
+  // From the producer, false when the ring is full, which leaves |event| as
+  // it was
+  template <typename U>
+  bool Push(U&& event) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+    events_[tail & (Capacity - 1)] = std::forward<U>(event);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  // From the consumer, false when the ring is empty
+  bool Pop(T& event) {
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) return false;
+    event = std::move(events_[head & (Capacity - 1)]);
+    // sequentially consistent with WaitForRoom, so either the waiting
+    // producer sees the room or this sees it waiting
+    head_.store(head + 1, std::memory_order_seq_cst);
+    if (waiting_.load(std::memory_order_seq_cst)) {
+      std::lock_guard<std::mutex> lock(room_mutex_);
+      room_.notify_one();
+    }
+    return true;
+  }
+
+  // From the producer after Push failed, blocks until the consumer made room
+  // or |timeout| passed, false on timeout
+  template <typename Rep, typename Period>
+  bool WaitForRoom(std::chrono::duration<Rep, Period> timeout) {
+    std::unique_lock<std::mutex> lock(room_mutex_);
+    waiting_.store(true, std::memory_order_seq_cst);
+    bool room = room_.wait_for(lock, timeout, [this] {
+      return tail_.load(std::memory_order_relaxed) -
+                 head_.load(std::memory_order_seq_cst) <
+             Capacity;
+    });
+    waiting_.store(false, std::memory_order_relaxed);
+    return room;
+  }
+
+  // From the producer after pushing, true when the caller has to wake the
+  // consumer
+  bool ScheduleDrain() {
+    return !scheduled_.exchange(true, std::memory_order_acq_rel);
+  }
+
+  // From the consumer before popping, so that events pushed from then on
+  // schedule another drain
+  void BeginDrain() { scheduled_.exchange(false, std::memory_order_acq_rel); }
+
+ private:
+  std::array<T, Capacity> events_;
+  // only ever incremented, the difference is the number of events queued
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  alignas(64) std::atomic<bool> scheduled_{false};
+  // a producer is in WaitForRoom
+  std::atomic<bool> waiting_{false};
+  std::mutex room_mutex_;
+  std::condition_variable room_;
+};
+
+}  // namespace tty
+
+#endif  // AWRIT_TTY_EVENT_QUEUE_H
@@ -0,0 +1,89 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "event_queue.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using tty::EventQueue;
+
+TEST(EventQueueTest, PopsInOrder) {
+  EventQueue<int, 4> queue;
+  int event;
+  EXPECT_FALSE(queue.Pop(event));
+  for (int i = 0; i < 4; ++i) EXPECT_TRUE(queue.Push(i));
+  EXPECT_FALSE(queue.Push(4));
+  for (int i = 0; i < 4; ++i) {
+    ASSERT_TRUE(queue.Pop(event));
+    EXPECT_EQ(event, i);
+  }
+  EXPECT_FALSE(queue.Pop(event));
+}
+
+TEST(EventQueueTest, WrapsAround) {
+  EventQueue<int, 4> queue;
+  int event;
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_TRUE(queue.Push(i));
+    ASSERT_TRUE(queue.Push(i + 100));
+    ASSERT_TRUE(queue.Pop(event));
+    EXPECT_EQ(event, i);
+    ASSERT_TRUE(queue.Pop(event));
+    EXPECT_EQ(event, i + 100);
+  }
+}
+
+TEST(EventQueueTest, SchedulesOneDrainPerBatch) {
+  EventQueue<int, 8> queue;
+  queue.Push(1);
+  EXPECT_TRUE(queue.ScheduleDrain());
+  queue.Push(2);
+  EXPECT_FALSE(queue.ScheduleDrain());
+
+  queue.BeginDrain();
+  int event;
+  while (queue.Pop(event)) {
+  }
+  queue.Push(3);
+  EXPECT_TRUE(queue.ScheduleDrain());
+}
+
+TEST(EventQueueTest, HandsOverAcrossThreads) {
+  constexpr int kEvents = 100000;
+  EventQueue<int, 64> queue;
+  std::thread producer([&queue] {
+    for (int i = 0; i < kEvents; ++i) {
+      while (!queue.Push(i)) std::this_thread::yield();
+    }
+  });
+  int expected = 0;
+  int event;
+  while (expected < kEvents) {
+    if (!queue.Pop(event)) {
+      std::this_thread::yield();
+      continue;
+    }
+    ASSERT_EQ(event, expected);
+    ++expected;
+  }
+  producer.join();
+}
+
+TEST(EventQueueTest, WaitsForRoom) {
+  EventQueue<int, 2> queue;
+  ASSERT_TRUE(queue.Push(1));
+  ASSERT_TRUE(queue.Push(2));
+  EXPECT_FALSE(queue.WaitForRoom(std::chrono::milliseconds(1)));
+
+  std::thread consumer([&queue] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    int event;
+    queue.Pop(event);
+  });
+  EXPECT_TRUE(queue.WaitForRoom(std::chrono::seconds(10)));
+  EXPECT_TRUE(queue.Push(3));
+  consumer.join();
+}
@@ -0,0 +1,92 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "graphics.h"
+
+#include "string/string_utils.h"
+
+namespace tty::graphics {
+
+std::optional<Reply> ReplyFromAPC(std::string_view apc) noexcept {
+  if (apc.empty() || apc.front() != 'G') return {};
+  apc.remove_prefix(1);
+
+  size_t semicolon = apc.find(';');
+  if (semicolon == std::string_view::npos) return {};
+
+  Reply reply;
+  for (auto key : string::split(apc.substr(0, semicolon), ',')) {
+    if (key.size() < 2 || key.substr(0, 2) != "i=") continue;
+    auto id = string::strtoint(key.substr(2));
+    if (!id || *id <= 0) return {};
+    reply.image_id = *id;
+  }
+  if (!reply.image_id) return {};
+
+  reply.message = apc.substr(semicolon + 1);
+  reply.ok = reply.message == "OK";
+  return reply;
+}
+
+std::optional<ModeReport> ModeReportFromCSI(std::string_view csi) noexcept {
+  constexpr std::string_view kSuffix = "$y";
+  if (csi.size() < 2 + kSuffix.size() || csi.front() != '?' ||
+      csi.substr(csi.size() - kSuffix.size()) != kSuffix) {
+    return {};
+  }
+  csi = csi.substr(1, csi.size() - 1 - kSuffix.size());
+
+  size_t semicolon = csi.find(';');
+  if (semicolon == std::string_view::npos) return {};
+  auto mode = string::strtoint(csi.substr(0, semicolon));
+  auto state = string::strtoint(csi.substr(semicolon + 1));
+  if (!mode || !state) return {};
+  return ModeReport{*mode, *state};
+}
+
+bool QueryParser::HandleUTF8Codepoint(uint32_t ch) {
+  if (ch < 0x80) {
+    input_ += static_cast<char>(ch);
+  } else if (ch < 0x800) {
+    input_ += static_cast<char>(0xc0 | ch >> 6);
+    input_ += static_cast<char>(0x80 | (ch & 0x3f));
+  } else if (ch < 0x10000) {
+    input_ += static_cast<char>(0xe0 | ch >> 12);
+    input_ += static_cast<char>(0x80 | (ch >> 6 & 0x3f));
+    input_ += static_cast<char>(0x80 | (ch & 0x3f));
+  } else {
+    input_ += static_cast<char>(0xf0 | ch >> 18);
+    input_ += static_cast<char>(0x80 | (ch >> 12 & 0x3f));
+    input_ += static_cast<char>(0x80 | (ch >> 6 & 0x3f));
+    input_ += static_cast<char>(0x80 | (ch & 0x3f));
+  }
+  return true;
+}
+
+bool QueryParser::HandleAPC(const std::string& apc) {
+  if (auto reply = ReplyFromAPC(apc)) replies_.push_back(std::move(*reply));
+  return true;
+}
+
+bool QueryParser::HandleCSI(const std::string& csi) {
+  if (auto report = ModeReportFromCSI(csi)) {
+    modes_.push_back(*report);
+  } else if (csi.size() > 1 && csi.front() == '?' && csi.back() == 'c') {
+    // primary device attributes, CSI ? <attributes> c
+    done_ = true;
+  } else {
+    // a key such as an arrow
+    input_ += "\x1b[" + csi;
+  }
+  return true;
+}
+
+void QueryParser::HandlePaste(std::string_view text, bool last) {
+  if (!pasting_) input_ += "\x1b[200~";
+  input_ += text;
+  pasting_ = !last;
+  if (last) input_ += "\x1b[201~";
+}
+
+}  // namespace tty::graphics
@@ -0,0 +1,74 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_TTY_GRAPHICS_H
+#define AWRIT_TTY_GRAPHICS_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "escape_parser.h"
+
+namespace tty::graphics {
+
+// The terminal's answer to a graphics command that carried an image id
+struct Reply {
+  uint32_t image_id = 0;
+  bool ok = false;
+  // "OK" or an error such as "ENOENT:Failed to open file"
+  std::string message;
+};
+
+// Parses the body of an APC sent by the terminal, like "Gi=31;OK"
+std::optional<Reply> ReplyFromAPC(std::string_view apc) noexcept;
+
+// The terminal's answer to a request for the state of a DEC private mode
+struct ModeReport {
+  int mode = 0;
+  // 0 unknown mode, 1 set, 2 reset, 3 permanently set, 4 permanently reset
+  int state = 0;
+
+  // the mode can be switched, or is always on
+  bool supported() const { return state >= 1 && state <= 3; }
+};
+
+// Parses the body of a DECRPM sent by the terminal, like "?2026;2$y"
+std::optional<ModeReport> ModeReportFromCSI(std::string_view csi) noexcept;
+
+// Collects the replies to graphics queries, along with the modes reported on
+// the way. Terminals answer in order, so the
+// primary device attributes requested after the queries arrive after every
+// reply, which also ends the wait on terminals without graphics support.
+//
+// Keys typed and text pasted in the meantime are kept, encoded again, so they
+// can be handed to the real input parser, see tty::in::Unread.
+class QueryParser : public EscapeCodeParser {
+ public:
+  // the device attributes have arrived
+  bool done() const { return done_; }
+  const std::vector<Reply>& replies() const { return replies_; }
+  const std::vector<ModeReport>& modes() const { return modes_; }
+  // what arrived besides the answers
+  const std::string& input() const { return input_; }
+
+ protected:
+  bool HandleUTF8Codepoint(uint32_t ch) override;
+  bool HandleAPC(const std::string& apc) override;
+  bool HandleCSI(const std::string& csi) override;
+  void HandlePaste(std::string_view text, bool last) override;
+
+ private:
+  bool done_ = false;
+  std::vector<Reply> replies_;
+  std::vector<ModeReport> modes_;
+  std::string input_;
+  bool pasting_ = false;
+};
+
+}  // namespace tty::graphics
+
+#endif  // AWRIT_TTY_GRAPHICS_H
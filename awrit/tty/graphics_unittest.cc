@@ -0,0 +1,90 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "graphics.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "tty/escape_codes.h"
+
+TEST(GraphicsTest, ReplyOK) {
+  auto reply = tty::graphics::ReplyFromAPC("Gi=31;OK");
+  ASSERT_TRUE(reply);
+  EXPECT_EQ(reply->image_id, 31u);
+  EXPECT_TRUE(reply->ok);
+}
+
+TEST(GraphicsTest, ReplyError) {
+  auto reply =
+      tty::graphics::ReplyFromAPC("Gi=32,p=4;ENOENT:Failed to open file");
+  ASSERT_TRUE(reply);
+  EXPECT_EQ(reply->image_id, 32u);
+  EXPECT_FALSE(reply->ok);
+  EXPECT_EQ(reply->message, "ENOENT:Failed to open file");
+}
+
+TEST(GraphicsTest, NotAReply) {
+  EXPECT_FALSE(tty::graphics::ReplyFromAPC(""));
+  EXPECT_FALSE(tty::graphics::ReplyFromAPC("Gi=31"));
+  EXPECT_FALSE(tty::graphics::ReplyFromAPC("G;OK"));
+  EXPECT_FALSE(tty::graphics::ReplyFromAPC("Xi=31;OK"));
+}
+
+TEST(GraphicsTest, QueryParserStopsAtDeviceAttributes) {
+  tty::graphics::QueryParser parser;
+  parser.Parse(ESC "_Gi=31;OK" ESC "\\" ESC "_Gi=33;EINVAL:bad" ESC "\\");
+  EXPECT_FALSE(parser.done());
+  parser.Parse(CSI "?62;22c");
+  EXPECT_TRUE(parser.done());
+
+  ASSERT_EQ(parser.replies().size(), 2u);
+  EXPECT_EQ(parser.replies()[0].image_id, 31u);
+  EXPECT_TRUE(parser.replies()[0].ok);
+  EXPECT_EQ(parser.replies()[1].image_id, 33u);
+  EXPECT_FALSE(parser.replies()[1].ok);
+}
+
+TEST(GraphicsTest, QueryParserWithoutGraphics) {
+  tty::graphics::QueryParser parser;
+  parser.Parse(CSI "?1;2c");
+  EXPECT_TRUE(parser.done());
+  EXPECT_TRUE(parser.replies().empty());
+}
+
+TEST(GraphicsTest, ModeReport) {
+  auto report = tty::graphics::ModeReportFromCSI("?2026;2$y");
+  ASSERT_TRUE(report);
+  EXPECT_EQ(report->mode, 2026);
+  EXPECT_EQ(report->state, 2);
+  EXPECT_TRUE(report->supported());
+
+  report = tty::graphics::ModeReportFromCSI("?2026;0$y");
+  ASSERT_TRUE(report);
+  EXPECT_FALSE(report->supported());
+
+  EXPECT_FALSE(tty::graphics::ModeReportFromCSI("?62;22c"));
+  EXPECT_FALSE(tty::graphics::ModeReportFromCSI("?2026$y"));
+  EXPECT_FALSE(tty::graphics::ModeReportFromCSI("2026;1$y"));
+}
+
+TEST(GraphicsTest, QueryParserCollectsModes) {
+  tty::graphics::QueryParser parser;
+  parser.Parse(ESC "_Gi=31;OK" ESC "\\" CSI "?2026;2$y" CSI "?62;22c");
+  EXPECT_TRUE(parser.done());
+  ASSERT_EQ(parser.modes().size(), 1u);
+  EXPECT_EQ(parser.modes()[0].mode, 2026);
+  EXPECT_TRUE(parser.modes()[0].supported());
+}
+
+TEST(GraphicsTest, QueryParserKeepsInput) {
+  tty::graphics::QueryParser parser;
+  parser.Parse("a\xc3\xa9" CSI "A" ESC "_Gi=31;OK" ESC "\\" CSI
+               "200~pasted" CSI "201~" CSI "?62;22c" "b");
+  EXPECT_TRUE(parser.done());
+  ASSERT_EQ(parser.replies().size(), 1u);
+  EXPECT_EQ(parser.input(),
+            "a\xc3\xa9" CSI "A" CSI "200~pasted" CSI "201~" "b");
+}
@@ -5,12 +5,31 @@
 #ifndef AWRIT_TTY_INPUT_H
 #define AWRIT_TTY_INPUT_H
 
-#include <string>
+#include <string_view>
 
 namespace tty::in {
 void Setup();
-bool WaitForReady(int timeout_ms = 20);
-std::string Read();
+// What ended WaitForReady
+enum class Wait {
+  // stdin has input, or was closed
+  ready,
+  timeout,
+  // Wake() was called
+  woken,
+  // stdin can't be polled, waiting again fails the same way, see errno
+  error,
+};
+// Blocks until stdin has input, |timeout_ms| passed or Wake() was called, a
+// negative |timeout_ms| waits indefinitely
+Wait WaitForReady(int timeout_ms = 20);
+// Wakes the thread in WaitForReady, from any thread
+void Wake();
+// Reads the input that is ready, the view is valid until the next Read and is
+// empty once stdin is closed
+std::string_view Read();
+// Hands |input| that was read by someone else back, the next Read returns it
+// before anything from stdin. Call it before the input thread starts reading.
+void Unread(std::string_view input);
 void Cleanup();
 }  // namespace tty::in
 
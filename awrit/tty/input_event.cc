@@ -21,4 +21,10 @@ bool InputEventParser::HandleCSI(const std::string& str) {
   return true;
 }
 
+bool InputEventParser::HandleAPC(const std::string& str) {
+  auto reply = tty::graphics::ReplyFromAPC(str);
+  if (reply) HandleGraphicsReply(*reply);
+  return true;
+}
+
 }  // namespace tty
@@ -6,6 +6,7 @@
 #define AWRIT_TTY_INPUT_EVENT_H
 
 #include "tty/escape_parser.h"
+#include "tty/graphics.h"
 #include "tty/kitty_keys.h"
 #include "tty/mouse.h"
 
@@ -15,7 +16,9 @@ class InputEventParser : public EscapeCodeParser {
  protected:
   virtual void HandleKey(const tty::keys::KeyEvent&) = 0;
   virtual void HandleMouse(const tty::mouse::MouseEvent&) = 0;
+  virtual void HandleGraphicsReply(const tty::graphics::Reply&) {}
   bool HandleCSI(const std::string& str) override;
+  bool HandleAPC(const std::string& str) override;
 };
 
 }  // namespace tty
@@ -4,7 +4,6 @@
 
 #include <csignal>
 #include <iostream>
-#include <thread>
 #include <unordered_map>
 #include <clocale>
 
@@ -189,10 +188,9 @@ int main() {
   std::wcout.imbue(std::locale(""));
 
   while (!quit) {
-    if (!tty::in::WaitForReady(10)) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      continue;
-    }
+    auto wait = tty::in::WaitForReady(-1);
+    if (wait == tty::in::Wait::error) break;
+    if (wait != tty::in::Wait::ready) continue;
     parser.Parse(tty::in::Read());
   }
 }
@@ -2,16 +2,77 @@
 // Use of this source code is governed by a BSD-style license that can be found
 // in the LICENSE file.
 
-#include <sys/select.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <termios.h>
 #include <unistd.h>
+#if defined(__linux__)
+#include <sys/eventfd.h>
+#endif
 
 #include <array>
+#include <cerrno>
+#include <cstdint>
+#include <string>
 
 #include "input.h"
 
 namespace tty::in {
 
+namespace {
+
+// Wakes WaitForReady through an eventfd, or a pipe where there is none
+class Waker {
+ public:
+  Waker() {
+#if defined(__linux__)
+    read_fd_ = write_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+#else
+    int fds[2];
+    if (pipe(fds) == 0) {
+      for (int fd : fds) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+        fcntl(fd, F_SETFL, O_NONBLOCK);
+      }
+      read_fd_ = fds[0];
+      write_fd_ = fds[1];
+    }
+#endif
+  }
+
+  int fd() const { return read_fd_; }
+
+  void Wake() {
+    uint64_t one = 1;
+    // a full pipe or counter already wakes the reader
+    [[maybe_unused]] auto written =
+        write(write_fd_, &one, write_fd_ == read_fd_ ? sizeof(one) : 1);
+  }
+
+  void Drain() {
+    uint64_t value;
+    while (read(read_fd_, &value, sizeof(value)) > 0) {
+    }
+  }
+
+ private:
+  int read_fd_ = -1;
+  int write_fd_ = -1;
+};
+
+Waker& GetWaker() {
+  static Waker waker;
+  return waker;
+}
+
+// input handed back by Unread
+std::string& GetUnread() {
+  static std::string unread;
+  return unread;
+}
+
+}  // namespace
+
 struct termios* get_terminal() {
   static struct termios terminal;
   return &terminal;
@@ -38,25 +99,52 @@ void Setup() {
 
 void Cleanup() { tcsetattr(STDIN_FILENO, TCSANOW, get_terminal()); }
 
-bool WaitForReady(int timeout_ms) {
-  const int kTimeout_us = timeout_ms * 1000;
+Wait WaitForReady(int timeout_ms) {
+  if (!GetUnread().empty()) return Wait::ready;
+  auto& waker = GetWaker();
+  pollfd fds[] = {{STDIN_FILENO, POLLIN, 0}, {waker.fd(), POLLIN, 0}};
+  int ready;
+  do {
+    ready = poll(fds, waker.fd() < 0 ? 1 : 2, timeout_ms < 0 ? -1 : timeout_ms);
+  } while (ready < 0 && errno == EINTR);
+  if (ready < 0) return Wait::error;
+  if (ready == 0) return Wait::timeout;
 
-  static timeval tv = {0, kTimeout_us};
-  fd_set fds;
-  FD_ZERO(&fds);
-  FD_SET(STDIN_FILENO, &fds);
-  select(STDIN_FILENO + 1, &fds, nullptr, nullptr, &tv);
-  return FD_ISSET(STDIN_FILENO, &fds);
+  if (fds[1].revents) {
+    waker.Drain();
+    return Wait::woken;
+  }
+  if (fds[0].revents & POLLNVAL) {
+    errno = EBADF;
+    return Wait::error;
+  }
+  // a closed stdin is ready too, so that Read can report it
+  return fds[0].revents ? Wait::ready : Wait::timeout;
 }
 
-std::string Read() {
+void Wake() { GetWaker().Wake(); }
+
+void Unread(std::string_view input) { GetUnread().append(input); }
+
+std::string_view Read() {
+  // the parsers keep their own state between reads, so the buffer is reused
+  // for every read instead of holding on to what was parsed
   static constexpr size_t kBufferSize = 4096;
   static std::array<char, kBufferSize> buffer;
-  size_t actual_size = read(STDIN_FILENO, buffer.data(), kBufferSize);
+  static std::string replayed;
+  if (!GetUnread().empty()) {
+    replayed = std::move(GetUnread());
+    GetUnread().clear();
+    return replayed;
+  }
+  ssize_t actual_size;
+  do {
+    actual_size = read(STDIN_FILENO, buffer.data(), kBufferSize);
+  } while (actual_size < 0 && errno == EINTR);
 
-  if (actual_size == 0) return {};
+  if (actual_size <= 0) return {};
 
-  return {buffer.data(), actual_size};
+  return {buffer.data(), static_cast<size_t>(actual_size)};
 }
 
 }  // namespace tty::in
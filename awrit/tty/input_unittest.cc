@@ -0,0 +1,89 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "input.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <thread>
+
+using tty::in::Wait;
+
+namespace {
+// Puts a pipe in place of stdin for the duration of a test
+class InputTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(pipe(fds_), 0);
+    stdin_ = dup(STDIN_FILENO);
+    ASSERT_GE(stdin_, 0);
+    ASSERT_EQ(dup2(fds_[0], STDIN_FILENO), STDIN_FILENO);
+  }
+
+  void TearDown() override {
+    dup2(stdin_, STDIN_FILENO);
+    close(stdin_);
+    close(fds_[0]);
+    if (fds_[1] >= 0) close(fds_[1]);
+  }
+
+  void Type(std::string_view input) {
+    ASSERT_EQ(write(fds_[1], input.data(), input.size()),
+              static_cast<ssize_t>(input.size()));
+  }
+
+  void CloseInput() {
+    close(fds_[1]);
+    fds_[1] = -1;
+  }
+
+ private:
+  int fds_[2] = {-1, -1};
+  int stdin_ = -1;
+};
+}  // namespace
+
+TEST_F(InputTest, TimesOutWithoutInput) {
+  EXPECT_EQ(tty::in::WaitForReady(0), Wait::timeout);
+}
+
+TEST_F(InputTest, ReadsWhatIsReady) {
+  Type("\x1b[A");
+  ASSERT_EQ(tty::in::WaitForReady(-1), Wait::ready);
+  EXPECT_EQ(tty::in::Read(), "\x1b[A");
+  EXPECT_EQ(tty::in::WaitForReady(0), Wait::timeout);
+}
+
+TEST_F(InputTest, ReadsUnreadInputFirst) {
+  Type("b");
+  tty::in::Unread("a");
+  ASSERT_EQ(tty::in::WaitForReady(0), Wait::ready);
+  EXPECT_EQ(tty::in::Read(), "a");
+  ASSERT_EQ(tty::in::WaitForReady(0), Wait::ready);
+  EXPECT_EQ(tty::in::Read(), "b");
+}
+
+TEST_F(InputTest, WakeInterruptsTheWait) {
+  std::thread waker([] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    tty::in::Wake();
+  });
+  EXPECT_EQ(tty::in::WaitForReady(-1), Wait::woken);
+  waker.join();
+  // the wakeup is used up
+  EXPECT_EQ(tty::in::WaitForReady(0), Wait::timeout);
+}
+
+TEST_F(InputTest, ReadsNothingOnceClosed) {
+  CloseInput();
+  ASSERT_EQ(tty::in::WaitForReady(-1), Wait::ready);
+  EXPECT_TRUE(tty::in::Read().empty());
+}
+
+TEST_F(InputTest, ReportsErrors) {
+  close(STDIN_FILENO);
+  EXPECT_EQ(tty::in::WaitForReady(-1), Wait::error);
+}
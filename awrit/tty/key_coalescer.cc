@@ -0,0 +1,95 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "key_coalescer.h"
+
+namespace tty::keys {
+
+namespace {
+
+// lock keys don't change what a key types beyond what the terminal reported
+constexpr int kTypingModifiers =
+    Modifiers::Shift | Modifiers::CapsLock | Modifiers::NumLock;
+
+bool SameKey(const KeyEvent& a, const KeyEvent& b) {
+  return a.windows_key_code == b.windows_key_code && a.key == b.key &&
+         a.shifted_key == b.shifted_key && a.modifiers == b.modifiers;
+}
+
+void AppendUTF16(std::u16string& text, uint32_t codepoint) {
+  if (codepoint < 0x10000) {
+    text.push_back(static_cast<char16_t>(codepoint));
+    return;
+  }
+  codepoint -= 0x10000;
+  text.push_back(static_cast<char16_t>(0xd800 + (codepoint >> 10)));
+  text.push_back(static_cast<char16_t>(0xdc00 + (codepoint & 0x3ff)));
+}
+
+}  // namespace
+
+uint32_t PrintableCharacter(const KeyEvent& event) {
+  if (event.windows_key_code || (event.modifiers & ~kTypingModifiers)) {
+    return 0;
+  }
+  uint32_t character = event.shifted_key ? event.shifted_key : event.key;
+  // control characters, delete and kitty's private use functional keys
+  if (character < 0x20 || character == 0x7f ||
+      (character >= 0xe000 && character <= 0xf8ff) || character > 0x10ffff) {
+    return 0;
+  }
+  return character;
+}
+
+void CoalesceKeys(const std::vector<KeyEvent>& keys, bool commit_text,
+                  std::vector<KeyAction>& actions) {
+  actions.clear();
+  // the start of the printable keys and releases that may become text
+  size_t run = 0;
+  size_t typed = 0;
+  auto end_run = [&] {
+    if (typed < 2) {
+      run = actions.size();
+      typed = 0;
+      return;
+    }
+    KeyAction commit;
+    std::vector<KeyAction> releases;
+    for (size_t i = run; i < actions.size(); ++i) {
+      const auto& event = actions[i].event;
+      if (event.type == Event::Up) {
+        releases.push_back(actions[i]);
+      } else {
+        AppendUTF16(commit.text, PrintableCharacter(event));
+      }
+    }
+    actions.resize(run);
+    actions.push_back(std::move(commit));
+    actions.insert(actions.end(), releases.begin(), releases.end());
+    run = actions.size();
+    typed = 0;
+  };
+
+  for (const auto& event : keys) {
+    if (event.type == Event::Repeat && !actions.empty()) {
+      const auto& last = actions.back().event;
+      if (actions.back().text.empty() && last.type == Event::Repeat &&
+          SameKey(last, event)) {
+        continue;
+      }
+    }
+
+    const bool printable = commit_text && PrintableCharacter(event);
+    if (!printable) end_run();
+    actions.push_back({event, {}});
+    if (!printable) {
+      run = actions.size();
+    } else if (event.type != Event::Up) {
+      ++typed;
+    }
+  }
+  end_run();
+}
+
+}  // namespace tty::keys
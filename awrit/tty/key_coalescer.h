@@ -0,0 +1,39 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_TTY_KEY_COALESCER_H
+#define AWRIT_TTY_KEY_COALESCER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "kitty_keys.h"
+
+namespace tty::keys {
+
+// A key to send, or text to insert in its place
+struct KeyAction {
+  KeyEvent event;
+  // when not empty, printable keys committed as a single insertion instead of
+  // |event|
+  std::u16string text;
+};
+
+// Reduces a run of keys that arrived together, which only happens while the
+// page or the link to the terminal lags behind:
+// - repeats of a held key collapse to one, so the page isn't still repeating
+//   long after the key was released
+// - given |commit_text|, two or more printable keys in a row become a single
+//   text insertion, followed by their releases
+// Every release is kept.
+void CoalesceKeys(const std::vector<KeyEvent>& keys, bool commit_text,
+                  std::vector<KeyAction>& actions);
+
+// The character |event| types, 0 for keys that don't type one by themselves
+uint32_t PrintableCharacter(const KeyEvent& event);
+
+}  // namespace tty::keys
+
+#endif  // AWRIT_TTY_KEY_COALESCER_H
@@ -0,0 +1,87 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "key_coalescer.h"
+
+#include <gtest/gtest.h>
+
+#include "third_party/keycodes/keyboard_codes_posix.h"
+
+using namespace tty::keys;
+
+namespace {
+KeyEvent Key(uint32_t key, Event::Type type = Event::Down, int modifiers = 0) {
+  KeyEvent event;
+  event.type = type;
+  event.key = key;
+  event.modifiers = modifiers;
+  return event;
+}
+
+KeyEvent Arrow(Event::Type type) {
+  KeyEvent event;
+  event.type = type;
+  event.windows_key_code = KeyboardCode::VKEY_DOWN;
+  return event;
+}
+}  // namespace
+
+TEST(KeyCoalescerTest, CollapsesRepeats) {
+  std::vector<KeyAction> actions;
+  CoalesceKeys({Arrow(Event::Down), Arrow(Event::Repeat), Arrow(Event::Repeat),
+                Arrow(Event::Repeat), Arrow(Event::Up)},
+               false, actions);
+  ASSERT_EQ(actions.size(), 3u);
+  EXPECT_EQ(actions[0].event.type, Event::Down);
+  EXPECT_EQ(actions[1].event.type, Event::Repeat);
+  EXPECT_EQ(actions[2].event.type, Event::Up);
+}
+
+TEST(KeyCoalescerTest, KeepsRepeatsOfDifferentKeys) {
+  std::vector<KeyAction> actions;
+  CoalesceKeys({Arrow(Event::Repeat), Key('a', Event::Repeat),
+                Arrow(Event::Repeat)},
+               false, actions);
+  EXPECT_EQ(actions.size(), 3u);
+}
+
+TEST(KeyCoalescerTest, CommitsTypedText) {
+  std::vector<KeyAction> actions;
+  CoalesceKeys({Key('h'), Key('h', Event::Up), Key('I', Event::Down, 1),
+                Key(0x1f600), Key('I', Event::Up, 1), Arrow(Event::Down)},
+               true, actions);
+  ASSERT_EQ(actions.size(), 4u);
+  EXPECT_EQ(actions[0].text, u"hI\U0001F600");
+  EXPECT_EQ(actions[1].event.key, 'h');
+  EXPECT_EQ(actions[1].event.type, Event::Up);
+  EXPECT_EQ(actions[2].event.key, 'I');
+  EXPECT_EQ(actions[2].event.type, Event::Up);
+  EXPECT_EQ(actions[3].event.windows_key_code, KeyboardCode::VKEY_DOWN);
+}
+
+TEST(KeyCoalescerTest, SendsASingleKeyAsIs) {
+  std::vector<KeyAction> actions;
+  CoalesceKeys({Key('a'), Key('a', Event::Up)}, true, actions);
+  ASSERT_EQ(actions.size(), 2u);
+  EXPECT_TRUE(actions[0].text.empty());
+  EXPECT_EQ(actions[0].event.type, Event::Down);
+}
+
+TEST(KeyCoalescerTest, ShortcutsAreNotText) {
+  std::vector<KeyAction> actions;
+  CoalesceKeys({Key('a'), Key('c', Event::Down, Modifiers::Ctrl), Key('b')},
+               true, actions);
+  ASSERT_EQ(actions.size(), 3u);
+  for (const auto& action : actions) EXPECT_TRUE(action.text.empty());
+}
+
+TEST(KeyCoalescerTest, PrintableCharacter) {
+  EXPECT_EQ(PrintableCharacter(Key('a')), 'a');
+  EXPECT_EQ(PrintableCharacter(Key('a', Event::Down, Modifiers::CapsLock)),
+            'a');
+  EXPECT_EQ(PrintableCharacter(Key('a', Event::Down, Modifiers::Alt)), 0u);
+  EXPECT_EQ(PrintableCharacter(Key(13)), 0u);
+  EXPECT_EQ(PrintableCharacter(Key(0x7f)), 0u);
+  EXPECT_EQ(PrintableCharacter(Arrow(Event::Down)), 0u);
+}
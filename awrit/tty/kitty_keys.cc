@@ -11,23 +11,23 @@
 #include <vector>
 
 #include "escape_codes.h"
+#include "output.h"
 #include "string/string_utils.h"
 #include "third_party/keycodes/keyboard_codes_posix.h"
 
 namespace tty::keys {
 
 void Enable() {
-  fprintf(stdout, CSI ">%du",
-          Flags::DisambiguateEscapeCodes | Flags::ReportEventTypes |
-              Flags::ReportAlternateKeys | Flags::ReportAllKeysAsEscapeCodes |
-              Flags::ReportAssociatedText);
-  fflush(stdout);
+  tty::out::Write(CSI ">" +
+                  std::to_string(Flags::DisambiguateEscapeCodes |
+                                 Flags::ReportEventTypes |
+                                 Flags::ReportAlternateKeys |
+                                 Flags::ReportAllKeysAsEscapeCodes |
+                                 Flags::ReportAssociatedText) +
+                  "u");
 }
 
-void Disable() {
-  fputs(CSI "<u", stdout);
-  fflush(stdout);
-}
+void Disable() { tty::out::Write(CSI "<u"); }
 
 namespace {
 
@@ -0,0 +1,41 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "mouse_coalescer.h"
+
+#include <utility>
+
+namespace tty::mouse {
+
+namespace {
+constexpr int kClickButtons = Button::Left | Button::Middle | Button::Right;
+constexpr int kWheelButtons = Button::WheelUp | Button::WheelDown |
+                               Button::WheelLeft | Button::WheelRight;
+}  // namespace
+
+bool Coalescer::Add(const MouseEvent& event) {
+  if (event.type == Event::Move) {
+    // a wheel held back at the earlier position stays ahead of the move
+    if (held_.wheel) return false;
+    held_.move = event;
+    return true;
+  }
+
+  if ((event.buttons & kClickButtons) || !(event.buttons & kWheelButtons)) {
+    return false;
+  }
+  // a modifier changes what the wheel does, zooming with Ctrl for one
+  if (held_.wheel && held_.wheel->modifiers != event.modifiers) return false;
+
+  held_.wheel = event;
+  if (event.buttons & Button::WheelUp) ++held_.wheel_y;
+  if (event.buttons & Button::WheelDown) --held_.wheel_y;
+  if (event.buttons & Button::WheelLeft) --held_.wheel_x;
+  if (event.buttons & Button::WheelRight) ++held_.wheel_x;
+  return true;
+}
+
+Coalescer::Held Coalescer::Take() { return std::exchange(held_, {}); }
+
+}  // namespace tty::mouse
@@ -0,0 +1,47 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_TTY_MOUSE_COALESCER_H
+#define AWRIT_TTY_MOUSE_COALESCER_H
+
+#include <optional>
+
+#include "mouse.h"
+
+namespace tty::mouse {
+
+// Pixel mouse tracking reports every pixel of motion and every wheel notch,
+// far more than a frame can show. This holds moves and wheel notches back
+// until the next frame, collapsing moves to the latest position and summing
+// the wheel per axis.
+//
+// Presses and releases are barriers: the caller sends what is held back
+// before them, so everything stays in order relative to them.
+class Coalescer {
+ public:
+  // What was held back since the last Take, the move goes first
+  struct Held {
+    std::optional<MouseEvent> move;
+    // the latest wheel event, for its position and modifiers
+    std::optional<MouseEvent> wheel;
+    // notches, positive to the right and up
+    int wheel_x = 0;
+    int wheel_y = 0;
+
+    bool empty() const { return !move && !wheel; }
+  };
+
+  // Holds |event| back, false when it is a barrier that has to be sent after
+  // Take()
+  bool Add(const MouseEvent& event);
+  Held Take();
+  bool empty() const { return held_.empty(); }
+
+ private:
+  Held held_;
+};
+
+}  // namespace tty::mouse
+
+#endif  // AWRIT_TTY_MOUSE_COALESCER_H
@@ -0,0 +1,62 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "mouse_coalescer.h"
+
+#include <gtest/gtest.h>
+
+using namespace tty::mouse;
+
+namespace {
+MouseEvent Move(int x, int y) { return {Event::Move, Button::None, 0, x, y}; }
+MouseEvent Wheel(int button, int modifiers = 0) {
+  return {Event::Press, button, modifiers, 10, 20};
+}
+}  // namespace
+
+TEST(MouseCoalescerTest, KeepsTheLatestMove) {
+  Coalescer coalescer;
+  for (int x = 0; x < 100; ++x) EXPECT_TRUE(coalescer.Add(Move(x, 5)));
+  auto held = coalescer.Take();
+  ASSERT_TRUE(held.move);
+  EXPECT_EQ(held.move->x, 99);
+  EXPECT_EQ(held.move->y, 5);
+  EXPECT_FALSE(held.wheel);
+  EXPECT_TRUE(coalescer.empty());
+}
+
+TEST(MouseCoalescerTest, SumsTheWheelPerAxis) {
+  Coalescer coalescer;
+  EXPECT_TRUE(coalescer.Add(Wheel(Button::WheelUp)));
+  EXPECT_TRUE(coalescer.Add(Wheel(Button::WheelUp)));
+  EXPECT_TRUE(coalescer.Add(Wheel(Button::WheelDown)));
+  EXPECT_TRUE(coalescer.Add(Wheel(Button::WheelLeft)));
+  auto held = coalescer.Take();
+  ASSERT_TRUE(held.wheel);
+  EXPECT_EQ(held.wheel_y, 1);
+  EXPECT_EQ(held.wheel_x, -1);
+}
+
+TEST(MouseCoalescerTest, ClicksAreBarriers) {
+  Coalescer coalescer;
+  EXPECT_TRUE(coalescer.Add(Move(1, 1)));
+  EXPECT_FALSE(coalescer.Add({Event::Press, Button::Left, 0, 1, 1}));
+  EXPECT_FALSE(coalescer.Add({Event::Release, Button::Left, 0, 1, 1}));
+  EXPECT_FALSE(coalescer.Add({Event::Release, Button::None, 0, 1, 1}));
+  // the caller sends what is held back before the barrier
+  EXPECT_FALSE(coalescer.empty());
+}
+
+TEST(MouseCoalescerTest, ModifiersSplitTheWheel) {
+  Coalescer coalescer;
+  EXPECT_TRUE(coalescer.Add(Wheel(Button::WheelUp)));
+  EXPECT_FALSE(coalescer.Add(Wheel(Button::WheelUp, Modifier::Ctrl)));
+}
+
+TEST(MouseCoalescerTest, MovesStayBehindTheWheel) {
+  Coalescer coalescer;
+  EXPECT_TRUE(coalescer.Add(Move(1, 1)));
+  EXPECT_TRUE(coalescer.Add(Wheel(Button::WheelDown)));
+  EXPECT_FALSE(coalescer.Add(Move(2, 2)));
+}
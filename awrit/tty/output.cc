@@ -4,63 +4,222 @@
 
 #include "output.h"
 
+#include <fcntl.h>
 #include <sys/ioctl.h>
+#include <unistd.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdarg>
 #include <cstdio>
 
-#include "third_party/modp_b64.h"
+#include "simd/base64.h"
+#include "output_queue.h"
 
 namespace tty::out {
 
-void ClearScreen() { fputs(CLEAR_SCREEN, stdout); }
-void SetTitle(const std::string& title) {
-  std::string out = ESC "]2;" + title + "\a";
-  fputs(out.c_str(), stdout);
-  fflush(stdout);
+namespace {
+using Lane = OutputQueue::Lane;
+
+// Until Setup opens the terminal on a descriptor of its own, output goes to
+// whatever stdout currently is
+OutputQueue& Queue() {
+  static OutputQueue queue(STDOUT_FILENO);
+  return queue;
+}
+
+// the terminal opened non-blocking, so that a full tty never blocks the
+// writer in the middle of a batch it could split, -1 when not opened
+int terminal_fd = -1;
+
+std::atomic<bool> synchronized_updates{false};
+
+// appends printf style to |out|
+void Append(std::string& out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+void Append(std::string& out, const char* format, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, format);
+  int length = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+  if (length > 0)
+    out.append(buffer, std::min<size_t>(length, sizeof(buffer) - 1));
 }
+}  // namespace
+
+void Write(std::string data) { Queue().Write(std::move(data)); }
+
+void Flush() { Queue().Flush(); }
+
+void WaitForGraphicsBelow(size_t bytes) { Queue().WaitForBulkBelow(bytes); }
+
+void ClearScreen() { Write(CLEAR_SCREEN); }
+void SetTitle(const std::string& title) { Write(ESC "]2;" + title + "\a"); }
 
 Size WindowSize() {
-  struct winsize sz;
+  struct winsize sz = {};
   ioctl(0, TIOCGWINSZ, &sz);
   return {sz.ws_xpixel, sz.ws_ypixel};
 }
 
-void PlaceCursor(Point point) { printf(CSI "%d;%dH", point.x, point.y); }
+Size WindowCells() {
+  struct winsize sz = {};
+  ioctl(0, TIOCGWINSZ, &sz);
+  return {sz.ws_col, sz.ws_row};
+}
 
-void PaintBitmap(const std::string_view name, const Size size,
-                 const Point point, const NameType type) {
-  size_t encoded_len = modp_b64_encode_data_len(name.size());
-  std::string encoded;
-  encoded.resize(encoded_len);
-  encoded_len = modp_b64_encode_data(encoded.data(), name.data(), name.size());
+namespace {
+std::string CursorTo(Point point) {
+  std::string out;
+  Append(out, CSI "%d;%dH", point.y + 1, point.x + 1);
+  return out;
+}
+}  // namespace
 
-  PlaceCursor({0, 0});
-  fprintf(stdout, ESC "_Gf=32,a=T,s=%d,v=%d,t=%c,x=%d,y=%d,C=1;", size.width,
-          size.height, type, point.x, point.y);
-  fwrite(encoded.data(), encoded.length(), 1, stdout);
-  fprintf(stdout, ESC "\\");
-  fflush(stdout);
+void PlaceCursor(Point point) { Write(CursorTo(point)); }
+
+namespace {
+// Encodes |data| onto the end of |out|
+void AppendBase64(std::string& out, const std::string_view data) {
+  size_t size = out.size();
+  out.resize(size + simd::Base64EncodedSize(data.size()));
+  out.resize(size + simd::Base64Encode(out.data() + size, data.data(),
+                                         data.size()));
 }
 
-void SetModes(const std::vector<Mode>& modes, bool enabled) {
+// Finishes the graphics command started in |command| with the data of
+// |source|. Direct data is split into chunks, each its own piece on the
+// graphics lane, so that control output can go out between them.
+void WriteSource(std::string command, const Source& source, Lane lane) {
+  Append(command, ",t=%c", source.type);
+  if (source.type != NameType::direct) {
+    if (source.size) Append(command, ",S=%zu", source.size);
+    if (source.offset) Append(command, ",O=%zu", source.offset);
+    command += ';';
+    AppendBase64(command, source.name);
+    command += ESC "\\";
+    Queue().Write(std::move(command), lane);
+    return;
+  }
+
+  if (source.compressed) command += ",o=z";
+  // each chunk is encoded straight into its own piece
+  constexpr size_t kChunkBytes = kMaxDirectChunk / 4 * 3;
+  const std::string_view data = source.name;
+  size_t offset = 0;
+  do {
+    size_t length = std::min(kChunkBytes, data.size() - offset);
+    bool more = offset + length < data.size();
+    std::string chunk = offset ? ESC "_G" : std::move(command);
+    Append(chunk, offset ? "m=%d;" : ",m=%d;", more);
+    chunk.reserve(chunk.size() + simd::Base64EncodedSize(length) + 2);
+    AppendBase64(chunk, data.substr(offset, length));
+    chunk += ESC "\\";
+    Queue().Write(std::move(chunk), lane);
+    offset += length;
+  } while (offset < data.size());
+}
+}  // namespace
+
+void PaintBitmap(const Source& source, const Size size,
+                 const Placement& placement) {
+  // the cursor goes with the command, so no other output can move it between
+  std::string command = CursorTo(placement.cell);
+  Append(command, ESC "_Gf=%d,a=T,s=%d,v=%d,C=1", source.format, size.width,
+         size.height);
+  const auto& offset = placement.offset;
+  if (offset.x || offset.y) Append(command, ",X=%d,Y=%d", offset.x, offset.y);
+  const auto& cells = placement.cells;
+  if (cells.width && cells.height)
+    Append(command, ",c=%d,r=%d", cells.width, cells.height);
+  if (placement.z_index) Append(command, ",z=%d", placement.z_index);
+  if (placement.image_id) {
+    Append(command, ",i=%u", placement.image_id);
+    if (placement.placement_id)
+      Append(command, ",p=%u", placement.placement_id);
+    if (!placement.acknowledge) command += ",q=2";
+  }
+  WriteSource(std::move(command), source, Lane::bulk);
+}
+
+void EditBitmap(const Source& source, const Size size, const Point offset,
+                uint32_t image_id, bool acknowledge) {
+  std::string command;
+  // r=1 edits the root frame, which is the one being displayed
+  Append(command, ESC "_Ga=f,r=1,i=%u,f=%d,s=%d,v=%d,x=%d,y=%d", image_id,
+         source.format, size.width, size.height, offset.x, offset.y);
+  if (!acknowledge) command += ",q=2";
+  WriteSource(std::move(command), source, Lane::bulk);
+}
+
+void QueryBitmap(const Source& source, uint32_t image_id) {
+  std::string command;
+  Append(command, ESC "_Ga=q,i=%u,f=%d,s=1,v=1", image_id, source.format);
+  // on the control lane, like the requests that have to be answered after it
+  WriteSource(std::move(command), source, Lane::control);
+}
+
+void DeleteImage(uint32_t image_id) {
+  std::string command;
+  // an upper case I frees the data along with the placements
+  Append(command, ESC "_Ga=d,d=I,i=%u,q=2" ESC "\\", image_id);
+  Queue().Write(std::move(command), Lane::bulk);
+}
+
+void RequestDeviceAttributes() { Write(PRIMARY_DEVICE_ATTRIBUTES); }
+
+namespace {
+std::string ModeSequence(const std::vector<Mode>& modes, bool enabled) {
   std::string buf = "";
   for (const auto& mode : modes) {
     buf += CSI MODE + std::to_string(static_cast<int>(mode)) +
            (enabled ? "h" : "l");
   }
-  fputs(buf.c_str(), stdout);
+  return buf;
+}
+}  // namespace
+
+void SetModes(const std::vector<Mode>& modes, bool enabled) {
+  Write(ModeSequence(modes, enabled));
+}
+
+void RequestMode(Mode mode) {
+  std::string request;
+  Append(request, CSI MODE "%d$p", static_cast<int>(mode));
+  Write(std::move(request));
+}
+
+void EnableSynchronizedUpdates(bool enabled) { synchronized_updates = enabled; }
+
+// the markers bracket graphics commands, so they take the same lane
+void BeginSynchronizedUpdate() {
+  if (!synchronized_updates) return;
+  Queue().Write(ModeSequence({pending_update}, true), Lane::bulk);
+}
+
+void EndSynchronizedUpdate() {
+  if (!synchronized_updates) return;
+  Queue().Write(ModeSequence({pending_update}, false), Lane::bulk);
 }
 
 void Setup() {
-  fputs(S7C1T SAVE_CURSOR SAVE_PRIVATE_MODE_VALUES SAVE_COLORS
-            DECSACE_DEFAULT_REGION_SELECT RESET_IRM,
-        stdout);
+  if (isatty(STDOUT_FILENO)) {
+    // a file description of our own, setting O_NONBLOCK on the shared one
+    // would also affect stdin and whatever runs in the terminal after us
+    if (const char* name = ttyname(STDOUT_FILENO)) {
+      terminal_fd = open(name, O_WRONLY | O_NONBLOCK | O_NOCTTY | O_CLOEXEC);
+      if (terminal_fd >= 0) Queue().SetFd(terminal_fd);
+    }
+  }
+
+  std::string out = S7C1T SAVE_CURSOR SAVE_PRIVATE_MODE_VALUES SAVE_COLORS
+      DECSACE_DEFAULT_REGION_SELECT RESET_IRM;
   // clang-format off
-  SetModes({
+  out += ModeSequence({
     text_cursor,
     cursor_key_to_app,
     reverse_video,
-    bracketed_paste,
     focus_tracking,
     mouse_button_tracking,
     mouse_motion_tracking,
@@ -71,29 +230,42 @@ void Setup() {
   // clang-format on
 
   // clang-format off
-  SetModes({
+  out += ModeSequence({
     auto_repeat,
     auto_wrap,
     alternate_screen,
+    bracketed_paste,
   }, true);
   // clang-format on
-  fputs(CLEAR_SCREEN, stdout);
-
-  fflush(stdout);
+  out += CLEAR_SCREEN;
+  Write(std::move(out));
 }
 
 void Cleanup() {
-  fputs(CLEAR_SCREEN, stdout);
+  // control output would otherwise overtake graphics still queued, which
+  // would then land on the main screen
+  Flush();
+  std::string out = CLEAR_SCREEN;
+  // in case a frame was cut short
+  if (synchronized_updates) out += ModeSequence({pending_update}, false);
   // clang-format off
-  SetModes({
+  out += ModeSequence({
     alternate_screen,
+    bracketed_paste,
     mouse_move_tracking,
     mouse_sgr_pixel_mode
   }, false);
   // clang-format on
-  SetModes({text_cursor}, true);
-  fputs(RESTORE_PRIVATE_MODE_VALUES RESTORE_CURSOR RESTORE_COLORS, stdout);
-  fflush(stdout);
+  out += ModeSequence({text_cursor}, true);
+  out += RESTORE_PRIVATE_MODE_VALUES RESTORE_CURSOR RESTORE_COLORS;
+  Write(std::move(out));
+  Flush();
+
+  if (terminal_fd >= 0) {
+    Queue().SetFd(STDOUT_FILENO);
+    close(terminal_fd);
+    terminal_fd = -1;
+  }
 }
 
 }  // namespace tty::out
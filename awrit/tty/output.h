@@ -5,6 +5,8 @@
 #ifndef AWRIT_TTY_OUTPUT_H
 #define AWRIT_TTY_OUTPUT_H
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -13,6 +15,17 @@
 
 namespace tty::out {
 
+// Output is queued and written to the terminal by a thread of its own, so
+// none of these block on a slow terminal. Control output, which is everything
+// but graphics commands, goes ahead of queued graphics, even between the
+// chunks of a large direct image.
+void Write(std::string data);
+// Blocks until everything queued so far has been written
+void Flush();
+// Blocks until less than |bytes| of graphics commands are queued, for threads
+// producing frames faster than the terminal takes them
+void WaitForGraphicsBelow(size_t bytes);
+
 void ClearScreen();
 void SetTitle(const std::string& title);
 
@@ -27,16 +40,89 @@ struct Point {
 };
 
 Size WindowSize();
+// the size in columns and rows
+Size WindowCells();
+// |point| is the zero-based column and row
 void PlaceCursor(Point point = {0, 0});
 
 void Setup();
+// Also waits for everything queued to be written
 void Cleanup();
 
-enum NameType : char { shm = 's', file = 't' };
+// t=s names a POSIX shared memory object that the terminal unlinks after
+// reading, t=t names a temporary file that it deletes after reading and t=f
+// names a regular file that is left untouched. t=d sends the pixel data
+// itself, which works even where the terminal cannot see our files.
+enum NameType : char {
+  shm = 's',
+  file = 't',
+  regular_file = 'f',
+  direct = 'd'
+};
+
+// most base64 bytes the terminal accepts in a single chunk of direct data
+constexpr size_t kMaxDirectChunk = 4096;
+
+// Pixel formats, the value is the number of bits per pixel
+enum Format : int { rgb = 24, rgba = 32 };
 
-void PaintBitmap(const std::string_view name, const Size size,
-                 const Point point = {0, 0},
-                 const NameType type = NameType::shm);
+// Where the terminal reads the pixel data of an image from
+struct Source {
+  // the name of the object holding the pixels, or the pixels themselves when
+  // |type| is NameType::direct
+  std::string_view name;
+  NameType type = NameType::shm;
+  Format format = Format::rgba;
+  // bytes to read starting at |offset|, 0 reads everything
+  size_t size = 0;
+  size_t offset = 0;
+  // direct data is zlib compressed
+  bool compressed = false;
+};
+
+// How a transmitted bitmap is displayed
+struct Placement {
+  // non-zero ids replace the image and placement sent with the same ids
+  // before, so the terminal keeps a single copy instead of a new one per frame
+  uint32_t image_id = 0;
+  uint32_t placement_id = 0;
+  // the column and row of the top-left corner, and the pixels it is shifted
+  // by within that cell
+  Point cell = {0, 0};
+  Point offset = {0, 0};
+  // columns and rows to stretch the bitmap over, zero keeps its pixel size
+  Size cells = {0, 0};
+  // images with a higher z-index are drawn over those with a lower one
+  int z_index = 0;
+  // the terminal only answers commands with an image id when this is set
+  bool acknowledge = false;
+};
+
+// Transmits and displays a bitmap
+void PaintBitmap(const Source& source, const Size size,
+                 const Placement& placement = {});
+
+// Replaces the |size| rectangle at |offset| of an already displayed image in
+// place, |source| only holds the pixels of that rectangle.
+//
+// Graphics commands keep their order among each other, and queued edits are
+// gathered into as few writes as possible.
+//
+// The terminal only answers commands with an image id when |acknowledge| is
+// set, the answer is an APC such as "Gi=<image_id>;OK".
+void EditBitmap(const Source& source, const Size size, const Point offset,
+                uint32_t image_id, bool acknowledge = false);
+
+// Asks whether the terminal can load a 1x1 RGB image from |source| without
+// storing it, the reply carries |image_id|. Follow the queries with
+// RequestDeviceAttributes to learn when every reply has arrived, both go out
+// as control output so they keep their order.
+void QueryBitmap(const Source& source, uint32_t image_id);
+
+// Deletes the image with |image_id| and its placements, which also frees its
+// data in the terminal. Queued in order with the graphics commands.
+void DeleteImage(uint32_t image_id);
+void RequestDeviceAttributes();
 
 // VT100/DEC Modes
 enum Mode : int {
@@ -59,6 +145,18 @@ enum Mode : int {
 
 void SetModes(const std::vector<Mode>& modes, bool enabled);
 
+// Asks whether the terminal supports |mode| (DECRQM), it answers with
+// CSI ? <mode> ; <state> $ y
+void RequestMode(Mode mode);
+
+// Output between the begin and end of a synchronized update is shown by the
+// terminal at once instead of as it arrives, so a frame sent as several
+// commands never shows half updated. Both do nothing until enabled, which
+// should only happen for terminals that reported supporting pending_update.
+void EnableSynchronizedUpdates(bool enabled);
+void BeginSynchronizedUpdate();
+void EndSynchronizedUpdate();
+
 }  // namespace tty::out
 
 #endif  // AWRIT_TTY_OUTPUT_H
@@ -0,0 +1,156 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "output_queue.h"
+
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+
+#include "frame/metrics.h"
+
+namespace tty {
+
+namespace {
+#ifdef IOV_MAX
+constexpr size_t kMaxIovecs = IOV_MAX;
+#else
+constexpr size_t kMaxIovecs = 1024;
+#endif
+}  // namespace
+
+OutputQueue::OutputQueue(int fd, size_t batch_bytes)
+    : batch_bytes_(batch_bytes), fd_(fd) {
+  thread_ = std::thread(&OutputQueue::Run, this);
+}
+
+OutputQueue::~OutputQueue() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stopping_ = true;
+  }
+  queued_.notify_one();
+  thread_.join();
+}
+
+void OutputQueue::Write(std::string piece, Lane lane) {
+  if (piece.empty()) return;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (lane == Lane::bulk) {
+      bulk_bytes_ += piece.size();
+      bulk_.push_back(std::move(piece));
+    } else {
+      control_.push_back(std::move(piece));
+    }
+  }
+  queued_.notify_one();
+}
+
+void OutputQueue::Flush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  written_.wait(lock, [this] {
+    return control_.empty() && bulk_.empty() && !writing_;
+  });
+}
+
+void OutputQueue::WaitForBulkBelow(size_t bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  written_.wait(lock, [this, bytes] { return bulk_bytes_ < bytes; });
+}
+
+size_t OutputQueue::pending_bulk() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return bulk_bytes_;
+}
+
+void OutputQueue::SetFd(int fd) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  fd_ = fd;
+}
+
+void OutputQueue::Run() {
+  std::vector<std::string> batch;
+  bool failed = false;
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    queued_.wait(lock, [this] {
+      return stopping_ || !control_.empty() || !bulk_.empty();
+    });
+    if (control_.empty() && bulk_.empty()) break;
+
+    // control output first, then as much bulk output as fits in the batch
+    size_t bytes = 0;
+    while (!control_.empty() && batch.size() < kMaxIovecs) {
+      bytes += control_.front().size();
+      batch.push_back(std::move(control_.front()));
+      control_.pop_front();
+    }
+    while (!bulk_.empty() && batch.size() < kMaxIovecs &&
+           (bytes < batch_bytes_ || batch.empty())) {
+      bytes += bulk_.front().size();
+      bulk_bytes_ -= bulk_.front().size();
+      batch.push_back(std::move(bulk_.front()));
+      bulk_.pop_front();
+    }
+    writing_ = true;
+    const int fd = fd_;
+
+    lock.unlock();
+    // a terminal that went away is not written to again, but the queue keeps
+    // draining so that nobody waits on it forever
+    if (!failed) failed = !WriteAll(fd, batch);
+    batch.clear();
+    lock.lock();
+
+    writing_ = false;
+    written_.notify_all();
+  }
+}
+
+bool OutputQueue::WriteAll(int fd, const std::vector<std::string>& batch) {
+  std::vector<iovec> iovecs;
+  iovecs.reserve(batch.size());
+  for (const auto& piece : batch) {
+    iovecs.push_back({const_cast<char*>(piece.data()), piece.size()});
+  }
+
+  size_t next = 0;
+  while (next < iovecs.size()) {
+    ssize_t written;
+    {
+      frame::metrics::Timer timer(frame::metrics::Stage::tty_write);
+      written = writev(fd, iovecs.data() + next,
+                       static_cast<int>(iovecs.size() - next));
+    }
+    if (written < 0) {
+      if (errno == EINTR) continue;
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        pollfd pfd = {fd, POLLOUT, 0};
+        poll(&pfd, 1, -1);
+        continue;
+      }
+      return false;
+    }
+
+    frame::metrics::Add(frame::metrics::Counter::tty_bytes, written);
+    // skip what was written, the first unfinished piece resumes part way
+    size_t left = written;
+    while (next < iovecs.size() && left >= iovecs[next].iov_len) {
+      left -= iovecs[next].iov_len;
+      ++next;
+    }
+    if (next < iovecs.size()) {
+      iovecs[next].iov_base = static_cast<char*>(iovecs[next].iov_base) + left;
+      iovecs[next].iov_len -= left;
+    }
+  }
+  return true;
+}
+
+}  // namespace tty
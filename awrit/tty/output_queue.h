@@ -0,0 +1,73 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#ifndef AWRIT_TTY_OUTPUT_QUEUE_H
+#define AWRIT_TTY_OUTPUT_QUEUE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace tty {
+
+// Writes to a file descriptor from a thread of its own, so that callers only
+// ever queue output and never block on a slow terminal.
+//
+// Output goes through two lanes. Control output such as titles, mode changes
+// and key protocol switches is small and goes ahead of bulk output. Bulk
+// output is graphics commands, queued as pieces that are each whole escape
+// codes, so control output can slip in between the chunks of a
+// multi-megabyte frame. Each lane keeps its own order.
+//
+// Pieces are gathered into a single writev() of up to |batch_bytes|, and a
+// non-blocking descriptor is waited on with poll() when the terminal is full.
+class OutputQueue {
+ public:
+  enum class Lane { control, bulk };
+
+  explicit OutputQueue(int fd, size_t batch_bytes = 64 * 1024);
+  // Writes what is still queued
+  ~OutputQueue();
+
+  OutputQueue(const OutputQueue&) = delete;
+  OutputQueue& operator=(const OutputQueue&) = delete;
+
+  void Write(std::string piece, Lane lane = Lane::control);
+  // Blocks until everything queued so far has been written
+  void Flush();
+  // Blocks until less than |bytes| of bulk output is queued, for producers
+  // that would otherwise outrun the terminal
+  void WaitForBulkBelow(size_t bytes);
+  // Bulk output that is queued and not written yet
+  size_t pending_bulk();
+
+  // Writes to |fd| from the next batch on, the caller keeps owning it
+  void SetFd(int fd);
+
+ private:
+  const size_t batch_bytes_;
+  std::mutex mutex_;
+  std::condition_variable queued_;
+  std::condition_variable written_;
+  std::deque<std::string> control_;
+  std::deque<std::string> bulk_;
+  size_t bulk_bytes_ = 0;
+  // pieces taken off the lanes that are being written
+  bool writing_ = false;
+  bool stopping_ = false;
+  int fd_;
+  std::thread thread_;
+
+  void Run();
+  // Writes every piece of |batch|, false if the descriptor failed for good
+  static bool WriteAll(int fd, const std::vector<std::string>& batch);
+};
+
+}  // namespace tty
+
+#endif  // AWRIT_TTY_OUTPUT_QUEUE_H
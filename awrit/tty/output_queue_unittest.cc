@@ -0,0 +1,130 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "output_queue.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <string>
+#include <thread>
+
+using tty::OutputQueue;
+
+namespace {
+// Reads |size| bytes from |fd| on a thread of its own
+class Reader {
+ public:
+  Reader(int fd, size_t size)
+      : thread_([this, fd, size] {
+          char buffer[4096];
+          while (data_.size() < size) {
+            ssize_t got = read(fd, buffer, sizeof(buffer));
+            if (got <= 0) break;
+            data_.append(buffer, got);
+          }
+        }) {}
+
+  const std::string& Join() {
+    thread_.join();
+    return data_;
+  }
+
+ private:
+  std::string data_;
+  std::thread thread_;
+};
+}  // namespace
+
+TEST(OutputQueueTest, WritesInOrder) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  std::string expected;
+  {
+    OutputQueue queue(fds[1]);
+    for (int i = 0; i < 100; ++i) {
+      std::string piece = "piece" + std::to_string(i) + ";";
+      expected += piece;
+      queue.Write(piece, OutputQueue::Lane::bulk);
+    }
+    queue.Flush();
+    EXPECT_EQ(queue.pending_bulk(), 0u);
+  }
+  close(fds[1]);
+  Reader reader(fds[0], expected.size());
+  EXPECT_EQ(reader.Join(), expected);
+  close(fds[0]);
+}
+
+TEST(OutputQueueTest, ResumesPartialWrites) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+  // far more than a pipe holds, so writes come back short or with EAGAIN
+  std::string expected;
+  for (int i = 0; i < 64; ++i) expected += std::string(10000, 'a' + i % 26);
+
+  Reader reader(fds[0], expected.size());
+  {
+    OutputQueue queue(fds[1], 16 * 1024);
+    for (int i = 0; i < 64; ++i) {
+      queue.Write(expected.substr(i * 10000, 10000), OutputQueue::Lane::bulk);
+    }
+    queue.Flush();
+  }
+  EXPECT_EQ(reader.Join(), expected);
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(OutputQueueTest, ControlGoesAheadOfBulk) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  fcntl(fds[1], F_SETFL, O_NONBLOCK);
+
+  // fill the pipe so that the writer is stuck on its first batch
+  std::string filler;
+  const std::string block(4096, '.');
+  while (write(fds[1], block.data(), block.size()) > 0) filler += block;
+
+  std::string bulk;
+  {
+    // one bulk piece per batch
+    OutputQueue queue(fds[1], 1);
+    for (int i = 0; i < 5; ++i) {
+      std::string piece = "<bulk" + std::to_string(i) + ">";
+      bulk += piece;
+      queue.Write(piece, OutputQueue::Lane::bulk);
+    }
+    queue.Write("<control>");
+
+    Reader reader(fds[0], filler.size() + bulk.size() + 9);
+    queue.Flush();
+    auto output = reader.Join().substr(filler.size());
+    auto control = output.find("<control>");
+    ASSERT_NE(control, std::string::npos);
+    // at most the batch the writer was stuck on went out first
+    EXPECT_LT(control, output.find("<bulk2>"));
+  }
+  close(fds[0]);
+  close(fds[1]);
+}
+
+TEST(OutputQueueTest, WaitsForBulkToDrain) {
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  const std::string piece(100000, 'x');
+  Reader reader(fds[0], piece.size() * 4);
+  {
+    OutputQueue queue(fds[1]);
+    for (int i = 0; i < 4; ++i) queue.Write(piece, OutputQueue::Lane::bulk);
+    queue.WaitForBulkBelow(piece.size());
+    EXPECT_LT(queue.pending_bulk(), piece.size());
+  }
+  EXPECT_EQ(reader.Join().size(), piece.size() * 4);
+  close(fds[0]);
+  close(fds[1]);
+}
@@ -0,0 +1,187 @@
+// Copyright (c) 2023 Chase Colman. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be found
+// in the LICENSE file.
+
+#include "output.h"
+
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "frame/compress.h"
+#include "third_party/modp_b64.h"
+
+namespace {
+
+// runs |write| with stdout redirected into a temporary file
+std::string CaptureStdout(const std::function<void()>& write) {
+  fflush(stdout);
+  FILE* capture = tmpfile();
+  int saved = dup(STDOUT_FILENO);
+  dup2(fileno(capture), STDOUT_FILENO);
+  write();
+  tty::out::Flush();
+  fflush(stdout);
+  dup2(saved, STDOUT_FILENO);
+  close(saved);
+
+  std::string result;
+  rewind(capture);
+  char buffer[4096];
+  size_t read;
+  while ((read = fread(buffer, 1, sizeof(buffer), capture)) > 0) {
+    result.append(buffer, read);
+  }
+  fclose(capture);
+  return result;
+}
+
+struct Command {
+  std::string keys;
+  std::string payload;
+};
+
+// splits the kitty graphics commands out of |output|
+std::vector<Command> ParseCommands(const std::string& output) {
+  std::vector<Command> commands;
+  size_t start = 0;
+  while ((start = output.find(ESC "_G", start)) != std::string::npos) {
+    size_t end = output.find(ESC "\\", start);
+    std::string body = output.substr(start + 3, end - start - 3);
+    size_t semicolon = body.find(';');
+    commands.push_back({body.substr(0, semicolon), body.substr(semicolon + 1)});
+    start = end;
+  }
+  return commands;
+}
+
+}  // namespace
+
+TEST(OutputTest, DirectTransmissionRoundTrips) {
+  // noise so that the compressed data still spans several chunks
+  std::string pixels;
+  uint32_t seed = 1;
+  for (int i = 0; i < 200000; ++i) {
+    seed = seed * 1664525 + 1013904223;
+    pixels += static_cast<char>(seed >> 24);
+  }
+  std::string compressed;
+  ASSERT_TRUE(frame::Compress(pixels.data(), pixels.size(), compressed));
+
+  tty::out::Source source;
+  source.name = compressed;
+  source.type = tty::out::NameType::direct;
+  source.format = tty::out::Format::rgb;
+  source.compressed = true;
+  auto output = CaptureStdout(
+      [&] { tty::out::PaintBitmap(source, {500, 400}, {7}); });
+
+  auto commands = ParseCommands(output);
+  ASSERT_GT(commands.size(), 1u);
+  EXPECT_NE(commands.front().keys.find("t=d"), std::string::npos);
+  EXPECT_NE(commands.front().keys.find("o=z"), std::string::npos);
+  EXPECT_NE(commands.front().keys.find("f=24"), std::string::npos);
+  EXPECT_NE(commands.front().keys.find("i=7"), std::string::npos);
+
+  std::string encoded;
+  for (size_t i = 0; i < commands.size(); ++i) {
+    bool last = i + 1 == commands.size();
+    EXPECT_NE(commands[i].keys.find(last ? "m=0" : "m=1"), std::string::npos);
+    EXPECT_LE(commands[i].payload.size(), tty::out::kMaxDirectChunk);
+    EXPECT_EQ(commands[i].payload.size() % 4, 0u);
+    encoded += commands[i].payload;
+  }
+
+  std::string decoded(modp_b64_decode_len(encoded.size()), '\0');
+  size_t decoded_len =
+      modp_b64_decode(decoded.data(), encoded.data(), encoded.size());
+  ASSERT_NE(decoded_len, MODP_B64_ERROR);
+  decoded.resize(decoded_len);
+
+  std::string inflated;
+  ASSERT_TRUE(frame::Decompress(decoded.data(), decoded.size(), inflated));
+  EXPECT_EQ(inflated, pixels);
+}
+
+TEST(OutputTest, SharedMemoryName) {
+  tty::out::Source source;
+  source.name = "/awrit-1";
+  source.size = 1200;
+  auto output =
+      CaptureStdout([&] { tty::out::EditBitmap(source, {10, 30}, {5, 6}, 1); });
+
+  auto commands = ParseCommands(output);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].keys,
+            "a=f,r=1,i=1,f=32,s=10,v=30,x=5,y=6,q=2,t=s,S=1200");
+  EXPECT_EQ(commands[0].payload, "L2F3cml0LTE=");
+}
+
+TEST(OutputTest, AcknowledgedEdit) {
+  tty::out::Source source;
+  source.name = "/awrit-1";
+  auto output = CaptureStdout(
+      [&] { tty::out::EditBitmap(source, {10, 30}, {5, 6}, 1, true); });
+
+  auto commands = ParseCommands(output);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].keys, "a=f,r=1,i=1,f=32,s=10,v=30,x=5,y=6,t=s");
+}
+
+TEST(OutputTest, SynchronizedUpdates) {
+  auto output = CaptureStdout([] {
+    tty::out::BeginSynchronizedUpdate();
+    tty::out::EndSynchronizedUpdate();
+  });
+  EXPECT_EQ(output, "");
+
+  tty::out::EnableSynchronizedUpdates(true);
+  output = CaptureStdout([] {
+    tty::out::BeginSynchronizedUpdate();
+    tty::out::EndSynchronizedUpdate();
+  });
+  tty::out::EnableSynchronizedUpdates(false);
+  EXPECT_EQ(output, CSI "?2026h" CSI "?2026l");
+}
+
+TEST(OutputTest, StretchedPaint) {
+  tty::out::Source source;
+  source.name = "/awrit-1";
+  auto output = CaptureStdout([&] {
+    tty::out::PaintBitmap(source, {400, 300}, {1, 2, {}, {}, {80, 24}});
+  });
+
+  auto commands = ParseCommands(output);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].keys,
+            "f=32,a=T,s=400,v=300,C=1,c=80,r=24,i=1,p=2,q=2,t=s");
+}
+
+TEST(OutputTest, DeleteImage) {
+  auto output = CaptureStdout([] { tty::out::DeleteImage(3); });
+  EXPECT_EQ(output, ESC "_Ga=d,d=I,i=3,q=2" ESC "\\");
+}
+
+TEST(OutputTest, LayeredPaint) {
+  tty::out::Source source;
+  source.name = "/awrit-2";
+  tty::out::Placement placement;
+  placement.image_id = 2;
+  placement.placement_id = 1;
+  placement.cell = {3, 4};
+  placement.offset = {5, 6};
+  placement.z_index = 1;
+  auto output = CaptureStdout(
+      [&] { tty::out::PaintBitmap(source, {40, 30}, placement); });
+
+  EXPECT_EQ(output.find(CSI "5;4H"), 0u);
+  auto commands = ParseCommands(output);
+  ASSERT_EQ(commands.size(), 1u);
+  EXPECT_EQ(commands[0].keys,
+            "f=32,a=T,s=40,v=30,C=1,X=5,Y=6,z=1,i=2,p=1,q=2,t=s");
+}
@@ -13,7 +13,6 @@ namespace tty::sgr_mouse {
 void Enable() {
   using namespace tty::out;
   SetModes({mouse_sgr_pixel_mode, mouse_move_tracking}, true);
-  fflush(stdout);
 }
 
 std::optional<mouse::MouseEvent> MouseEventFromCSI(
@@ -4,92 +4,258 @@
 
 #include "tui.h"
 
-#include <sys/fcntl.h>
-#include <sys/ioctl.h>
-#include <sys/mman.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 
-#include <random>
-
-#include "include/cef_parser.h"
-#include "tty/escape_codes.h"
+#include "frame/cleanup.h"
+#include "frame/file_pool.h"
+#include "frame/mailbox.h"
+#include "frame/metrics_exporter.h"
+#include "frame/pacer.h"
+#include "frame/render_scale.h"
+#include "frame/shm_pool.h"
+#include "frame/stats.h"
+#include "painter.h"
 #include "tty/input.h"
 #include "tty/kitty_keys.h"
 #include "tty/output.h"
 #include "tty/sgr_mouse.h"
 
-void Initialize() {
+namespace {
+
+// A popup such as the list of a <select>
+struct Popup {
+  // BGRA, |size.width| * 4 bytes per row
+  std::vector<uint8_t> pixels;
+  frame::Size size;
+  // the area it covers, in the terminal's pixels
+  frame::Rect rect;
+  bool visible = false;
+  // posted and not painted yet
+  bool changed = false;
+};
+
+// Everything but |mailbox|, |popup| and the atomics is only touched by the
+// painter thread once it runs
+struct PaintState {
+  // frames rendered by CEF wait here for the painter thread
+  frame::FrameMailbox mailbox;
+  std::thread painter_thread;
+  std::unique_ptr<Painter> painter;
+  FILE* stats_file = nullptr;
+  frame::MetricsExporter metrics;
+  // holds rendering back until the terminal has taken the previous frames
+  frame::FramePacer pacer;
+  // answers to the view's and popups' commands, counted on the input thread
+  std::atomic<uint64_t> answers{0};
+  // set from the UI thread when the terminal lost the displayed image
+  std::atomic<bool> repaint{false};
+  // set from the UI thread when the displayed image is no longer needed
+  std::atomic<bool> drop_image{false};
+  std::atomic<float> render_scale{1};
+  // adjusts |render_scale| to the time frames take to paint, if enabled
+  std::unique_ptr<frame::RenderScaler> scaler;
+  // the UI thread has yet to apply a new |render_scale|
+  std::atomic<bool> rescaled{false};
+  // the popup posted from the UI thread, guarded by |popup_mutex|
+  std::mutex popup_mutex;
+  Popup popup;
+  // the popup being painted, swapped with |popup| to reuse its pixels
+  Popup painted_popup;
+};
+
+PaintState& GetPaintState() {
+  static PaintState state;
+  return state;
+}
+
+void WriteStats(PaintState& state, const frame::FrameStats& stats) {
+  if (!state.stats_file) return;
+  fprintf(state.stats_file, "%s\n", frame::FormatStats(stats).c_str());
+}
+
+void PaintFrame(PaintState& state, const frame::FrameMailbox::Frame& frame) {
+  if (state.repaint.exchange(false)) state.painter->Repaint();
+  if (state.drop_image.exchange(false)) state.painter->DropImage();
+  WriteStats(state, state.painter->Paint(frame));
+}
+
+// Sends the popup posted last, or deletes it once hidden
+void SendPopup(PaintState& state) {
+  auto& popup = state.painted_popup;
+  {
+    std::lock_guard<std::mutex> lock(state.popup_mutex);
+    if (!state.popup.changed) return;
+    std::swap(popup, state.popup);
+    state.popup.changed = false;
+  }
+
+  if (popup.visible) {
+    state.painter->PaintPopup(popup.pixels.data(), popup.size, popup.rect);
+  } else {
+    state.painter->HidePopup();
+  }
+}
+
+// Paints the newest frame whenever the previous one has been sent, so that a
+// slow terminal never holds up CEF's UI thread
+void RunPainter(PaintState& state) {
+  while (true) {
+    auto* frame = state.mailbox.Take();
+    if (!frame && state.mailbox.closed()) break;
+    SendPopup(state);
+    if (!frame) continue;
+
+    auto start = std::chrono::steady_clock::now();
+    PaintFrame(state, *frame);
+    if (!state.scaler) continue;
+
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    if (state.scaler->Painted(elapsed)) {
+      state.render_scale = state.scaler->scale();
+      state.rescaled = true;
+    }
+  }
+}
+
+}  // namespace
+
+void Initialize(const PaintOptions& options) {
+  auto& state = GetPaintState();
+  if (options.render_scale > 0) {
+    state.render_scale = std::clamp(options.render_scale, 0.25f, 1.0f);
+  } else {
+    state.scaler = std::make_unique<frame::RenderScaler>();
+  }
+  if (!options.stats_path.empty()) {
+    state.stats_file = fopen(options.stats_path.c_str(), "a");
+    if (state.stats_file) setvbuf(state.stats_file, nullptr, _IOLBF, 0);
+  }
+  if (!options.metrics_target.empty() &&
+      !state.metrics.Start(options.metrics_target)) {
+    fprintf(stderr, "Failed to export metrics to %s\r\n",
+            options.metrics_target.c_str());
+  }
+
   tty::out::Setup();
   tty::in::Setup();
+
+  frame::ShmPool::SweepStale();
+  frame::FilePool::SweepStale(frame::FilePool::DefaultDir());
+  frame::InstallSignalHandlers();
+  // probing reads the replies from the tty, which has to be in raw mode
+  auto support = ProbeGraphics(options.probe_cache_path);
+  tty::out::EnableSynchronizedUpdates(support && support->synchronized);
+  PainterOptions painter_options;
+  painter_options.tile_size = options.tile_size;
+  painter_options.shm_huge_pages = options.shm_huge_pages;
+  painter_options.transport = options.transport;
+  if (painter_options.transport == Transport::automatic) {
+    painter_options.transport = ChooseTransport(support);
+  }
+  painter_options.pacer = &state.pacer;
+  painter_options.answers = &state.answers;
+  state.painter = std::make_unique<Painter>(painter_options);
+
+  state.painter_thread = std::thread(RunPainter, std::ref(state));
+
   tty::keys::Enable();
   tty::sgr_mouse::Enable();
 }
 
 void Restore() {
+  auto& state = GetPaintState();
+  // let frames that are still being written finish before the tty is reset
+  state.mailbox.Close();
+  if (state.painter_thread.joinable()) state.painter_thread.join();
+  if (state.painter) {
+    state.painter->DeleteImages();
+    state.painter.reset();
+  }
+
   tty::keys::Disable();
   tty::in::Cleanup();
   tty::out::Cleanup();
+
+  if (state.stats_file) {
+    fclose(state.stats_file);
+    state.stats_file = nullptr;
+  }
+  state.metrics.Stop();
 }
 
 void Paint(const std::vector<CefRect>& dirtyRects, const void* buffer,
            int width, int height) {
   if (width == 0 || height == 0) [[unlikely]]
     return;
-  size_t buffer_size = width * height * sizeof(uint32_t);
-
-  // buffer is BGRA but RGBA is needed by tty::out::PaintBitmap
-  auto bgra_img = CefImage::CreateImage();
-  static bool first = true;
-  static std::string name;
-
-  // clears last buffer image
-  if (first) [[unlikely]] {
-    std::mt19937 engine(std::random_device{}());
-    std::uniform_int_distribution<unsigned int> dist(1);
-    name = "/awrit-" + std::to_string(dist(engine));
-    first = false;
-  } else [[likely]] {
-    bgra_img->RemoveRepresentation(1.0);
-  }
 
-  bgra_img->AddBitmap(1.0, width, height, CEF_COLOR_TYPE_BGRA_8888,
-                      CEF_ALPHA_TYPE_PREMULTIPLIED, buffer, buffer_size);
-  int n_width, n_height;  // should be the same as width/height :shrug:
-  auto rgba_bitmap =
-      bgra_img->GetAsBitmap(1.0, CEF_COLOR_TYPE_RGBA_8888,
-                            CEF_ALPHA_TYPE_PREMULTIPLIED, n_width, n_height);
-
-  if (!rgba_bitmap) [[unlikely]] {
-    fprintf(stderr, "Unable to convert BGRA to RGBA\r\n");
-    return;
+  std::vector<frame::Rect> dirty;
+  dirty.reserve(dirtyRects.size());
+  for (const auto& rect : dirtyRects) {
+    dirty.push_back({rect.x, rect.y, rect.width, rect.height});
   }
+  GetPaintState().mailbox.Post(buffer, {width, height}, dirty);
+}
 
-  int fd_ = shm_open(name.c_str(), O_RDWR | O_CREAT, 0600);
-  if (fd_ < 0) {
-    fprintf(stderr, "NO FD %s\r\n", name.c_str());
-    return;
+void PaintPopup(const void* buffer, int width, int height,
+                const CefRect& rect) {
+  auto& state = GetPaintState();
+  {
+    std::lock_guard<std::mutex> lock(state.popup_mutex);
+    auto& popup = state.popup;
+    const auto* pixels = static_cast<const uint8_t*>(buffer);
+    popup.pixels.assign(pixels, pixels + width * height * sizeof(uint32_t));
+    popup.size = {width, height};
+    popup.rect = {rect.x, rect.y, rect.width, rect.height};
+    popup.visible = true;
+    popup.changed = true;
   }
+  state.mailbox.WakeUp();
+}
 
-  if (ftruncate(fd_, buffer_size) < 0) {
-    fprintf(stderr, "BAD SIZE %lu\r\n", buffer_size);
-    return;
+void HidePopup() {
+  auto& state = GetPaintState();
+  {
+    std::lock_guard<std::mutex> lock(state.popup_mutex);
+    state.popup.visible = false;
+    state.popup.changed = true;
   }
+  state.mailbox.WakeUp();
+}
 
-  void* mem_ =
-      mmap(nullptr, buffer_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
-  if (mem_ == MAP_FAILED) {
-    fprintf(stderr, "MAP FAILED\r\rn");
-    return;
-  }
+void OnGraphicsReply(uint32_t image_id, bool ok) {
+  auto& state = GetPaintState();
+  if (image_id == Painter::kViewImageId) state.pacer.Acknowledged(ok);
+  if (image_id == Painter::kViewImageId || image_id == Painter::kPopupImageId)
+    ++state.answers;
+}
 
-  rgba_bitmap->GetData(mem_, buffer_size, 0);
+void DropImages() { GetPaintState().drop_image = true; }
 
-  if (mem_) [[likely]]
-    munmap(mem_, buffer_size);
-  if (fd_) [[likely]] {
-    close(fd_);
-  }
+float RenderScale() { return GetPaintState().render_scale; }
+
+bool TakeRescale() { return GetPaintState().rescaled.exchange(false); }
+
+void LogStats(const std::string& line) {
+  auto& state = GetPaintState();
+  if (!state.stats_file) return;
+  fprintf(state.stats_file, "%s\n", line.c_str());
+}
+
+bool ReadyForFrame() { return GetPaintState().pacer.Ready(); }
 
-  tty::out::PaintBitmap(name, {width, height}, {0, 0}, tty::out::NameType::shm);
+bool TakeRepaint() {
+  auto& state = GetPaintState();
+  if (!state.pacer.TakeError()) return false;
+  state.repaint = true;
+  return true;
 }
 
 CefSize WindowSize() {
@@ -5,14 +5,63 @@
 #ifndef AWRIT_TUI_H
 #define AWRIT_TUI_H
 
+#include <cstdint>
+#include <string>
+
 #include "include/cef_base.h"
 #include "include/cef_render_handler.h"
+#include "transport.h"
 
 CefSize WindowSize();
 
-void Initialize();
+struct PaintOptions {
+  // edge length in pixels of the tiles used to skip unchanged regions
+  int tile_size = 64;
+  // when set, a line of stats is appended to this file for every frame
+  std::string stats_path;
+  // when set, per-stage timings and counters are exported in the Prometheus
+  // text format to this file, or to a socket given as unix:<path>
+  std::string metrics_target;
+  // back shared memory segments with transparent huge pages where possible
+  bool shm_huge_pages = false;
+  Transport transport = Transport::automatic;
+  // where the outcome of probing the terminal is cached
+  std::string probe_cache_path;
+  // fraction of the terminal's pixels that frames are rendered at, the
+  // terminal stretches them back over the window. 0 adjusts it to the load.
+  float render_scale = 1;
+};
+
+void Initialize(const PaintOptions& options = {});
 void Restore();
 void Paint(const std::vector<CefRect>& dirtyRects, const void* buffer,
            int width, int height);
+// Shows a popup of |width| x |height| BGRA pixels over the view, covering
+// |rect| of the terminal's pixels
+void PaintPopup(const void* buffer, int width, int height,
+                const CefRect& rect);
+void HidePopup();
+
+// Frees the images held by the terminal once the next frame is painted, for
+// when the page navigates away
+void DropImages();
+
+// The render scale, which CEF applies through the device scale factor
+float RenderScale();
+// Whether the render scale was adjusted to the load since the last call, the
+// caller then has to let CEF know
+bool TakeRescale();
+
+// Appends |line| to the stats file, if there is one
+void LogStats(const std::string& line);
+
+// Every painted frame and popup asks the terminal for an acknowledgement,
+// which arrives on the input thread
+void OnGraphicsReply(uint32_t image_id, bool ok);
+// Whether the terminal has caught up and another frame should be rendered
+bool ReadyForFrame();
+// Whether the terminal lost the displayed image, the next frame is then sent
+// whole and the caller has to make sure there is one
+bool TakeRepaint();
 
 #endif  // AWRIT_TUI_H